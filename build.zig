@@ -19,13 +19,9 @@ pub fn build(b: *std.Build) void {
         .flags = &.{"-std=c99"},
     });
 
-    exe.linkSystemLibrary("X11");
-    exe.linkSystemLibrary("Xinerama");
-    exe.linkSystemLibrary("Xft");
-    exe.linkSystemLibrary("fontconfig");
+    link_x11(exe.root_module);
     exe.linkSystemLibrary("asound");
     exe.linkSystemLibrary("pulse");
-    exe.linkLibC();
 
     b.installArtifact(exe);
 
@@ -41,6 +37,92 @@ pub fn build(b: *std.Build) void {
     const exe_tests = b.addTest(.{ .root_module = exe.root_module });
     test_step.dependOn(&b.addRunArtifact(exe_tests).step);
 
+    const bench_layout = b.addExecutable(.{
+        .name = "bench-layout",
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("src/bench/layout_bench.zig"),
+            .target = target,
+            .optimize = .ReleaseFast,
+            .imports = &.{.{ .name = "geometry", .module = b.createModule(.{
+                .root_source_file = b.path("src/layouts/geometry.zig"),
+                .target = target,
+                .optimize = .ReleaseFast,
+            }) }},
+        }),
+    });
+    const bench_layout_step = b.step("bench-layout", "Benchmark layout geometry without an X server");
+    bench_layout_step.dependOn(&b.addRunArtifact(bench_layout).step);
+
+    const bench_rules = b.addExecutable(.{
+        .name = "bench-rules",
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("src/bench/rules_bench.zig"),
+            .target = target,
+            .optimize = .ReleaseFast,
+            .imports = &.{.{ .name = "rules", .module = b.createModule(.{
+                .root_source_file = b.path("src/rules.zig"),
+                .target = target,
+                .optimize = .ReleaseFast,
+            }) }},
+        }),
+    });
+    const bench_rules_step = b.step("bench-rules", "Benchmark window rule matching against synthetic windows");
+    bench_rules_step.dependOn(&b.addRunArtifact(bench_rules).step);
+
+    const event_trace = b.createModule(.{
+        .root_source_file = b.path("src/x11/event_trace.zig"),
+        .target = target,
+        .optimize = .ReleaseFast,
+    });
+    link_x11(event_trace);
+    const replay_traces = b.addExecutable(.{
+        .name = "replay-traces",
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("src/bench/replay_traces.zig"),
+            .target = target,
+            .optimize = .ReleaseFast,
+            .imports = &.{.{ .name = "event_trace", .module = event_trace }},
+        }),
+    });
+    replay_traces.linkLibC();
+    const generate_traces = b.addRunArtifact(replay_traces);
+    const trace_dir = generate_traces.addOutputDirectoryArg("traces");
+
+    const bench_replay_step = b.step("bench-replay", "Replay event traces through handle_event against a stub X server");
+    var previous_replay: ?*std.Build.Step = null;
+    for ([_][]const u8{ "session_start", "tag_storm", "title_spam" }) |scenario| {
+        const replay = add_replay_run(b, exe, trace_dir.path(b, b.fmt("{s}.trace", .{scenario})));
+        if (previous_replay) |previous| replay.step.dependOn(previous);
+        previous_replay = &replay.step;
+    }
+    if (b.args) |traces| {
+        for (traces) |path| {
+            const replay = add_replay_run(b, exe, .{ .cwd_relative = path });
+            if (previous_replay) |previous| replay.step.dependOn(previous);
+            previous_replay = &replay.step;
+        }
+    }
+    if (previous_replay) |last| bench_replay_step.dependOn(last);
+
+    const bench_e2e = b.addExecutable(.{
+        .name = "bench-e2e",
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("src/bench/e2e_bench.zig"),
+            .target = target,
+            .optimize = .ReleaseFast,
+        }),
+    });
+    bench_e2e.root_module.linkSystemLibrary("X11", .{});
+    bench_e2e.linkLibC();
+    const run_e2e = b.addRunArtifact(bench_e2e);
+    run_e2e.addArg("--wm");
+    run_e2e.addArtifactArg(exe);
+    run_e2e.addArgs(&.{ "--config", "resources/bench-config.goon" });
+    if (b.args) |args| run_e2e.addArgs(args);
+    run_e2e.has_side_effects = true;
+    const bench_e2e_step = b.step("bench-e2e", "Benchmark map, tag, focus and bar latency under Xvfb");
+    bench_e2e_step.dependOn(&run_e2e.step);
+
     const xephyr_step = b.step("xephyr", "Run in Xephyr (1280x800 on :2)");
     xephyr_step.dependOn(&add_xephyr_run(b, exe, false).step);
 
@@ -60,6 +142,21 @@ pub fn build(b: *std.Build) void {
     clean_step.dependOn(&b.addSystemCommand(&.{ "rm", "-rf", "zig-out", ".zig-cache" }).step);
 }
 
+fn link_x11(module: *std.Build.Module) void {
+    for ([_][]const u8{ "X11", "X11-xcb", "xcb", "Xinerama", "Xrandr", "Xft", "Xext", "freetype2", "fontconfig" }) |library| {
+        module.linkSystemLibrary(library, .{});
+    }
+    module.link_libc = true;
+}
+
+fn add_replay_run(b: *std.Build, exe: *std.Build.Step.Compile, trace: std.Build.LazyPath) *std.Build.Step.Run {
+    const replay = b.addRunArtifact(exe);
+    replay.addArgs(&.{ "-c", "resources/bench-config.goon", "--replay" });
+    replay.addFileArg(trace);
+    replay.has_side_effects = true;
+    return replay;
+}
+
 fn add_xephyr_run(b: *std.Build, exe: *std.Build.Step.Compile, multimon: bool) *std.Build.Step.Run {
     const kill_cmd = if (multimon)
         "pkill -9 Xephyr || true; Xephyr +xinerama -glamor -screen 640x480 -screen 640x480 :2 & sleep 1"
@@ -17,8 +17,11 @@ stdenv.mkDerivation {
 
   buildInputs = [
     xorg.libX11
+    xorg.libxcb
+    xorg.libXext
     xorg.libXft
     xorg.libXinerama
+    xorg.libXrandr
     xorg.libXrender
     freetype
     fontconfig
@@ -24,9 +24,13 @@
           pkgs.alacritty
           pkgs.st
           pkgs.xorg.xorgserver
+          pkgs.xorg.xrandr
           pkgs.xorg.libX11
+          pkgs.xorg.libxcb
+          pkgs.xorg.libXext
           pkgs.xorg.libXft
           pkgs.xorg.libXinerama
+          pkgs.xorg.libXrandr
           pkgs.xorg.libXrender
           pkgs.freetype
           pkgs.fontconfig
@@ -4,6 +4,9 @@ const monitor_mod = @import("../monitor.zig");
 const client_mod = @import("../client.zig");
 const blocks_mod = @import("blocks/blocks.zig");
 const config_mod = @import("../config/config.zig");
+const shm_surface = @import("shm_surface.zig");
+const memory = @import("../memory.zig");
+const log = @import("../log.zig");
 
 const Monitor = monitor_mod.Monitor;
 const Block = blocks_mod.Block;
@@ -39,6 +42,7 @@ pub const Bar = struct {
     pixmap: xlib.Pixmap,
     graphics_context: xlib.GC,
     xft_draw: ?*xlib.XftDraw,
+    surface: ?*shm_surface.Surface,
     width: i32,
     height: i32,
     monitor: *Monitor,
@@ -115,6 +119,15 @@ pub const Bar = struct {
         _ = xlib.XMapWindow(display, window);
 
         const cfg = config_mod.get_config();
+        var surface: ?*shm_surface.Surface = null;
+        if (cfg) |c| {
+            if (c.bar_shm) {
+                surface = shm_surface.Surface.create(allocator, display, screen, window, monitor.mon_w, bar_height, font);
+                if (surface == null) {
+                    log.warn(.bar, "mit-shm unavailable, using xlib rendering", .{});
+                }
+            }
+        }
         const scheme_normal = if (cfg) |c| ColorScheme{ .foreground = c.scheme_normal.fg, .background = c.scheme_normal.bg, .border = c.scheme_normal.border } else ColorScheme{ .foreground = 0xbbbbbb, .background = 0x1a1b26, .border = 0x444444 };
         const scheme_selected = if (cfg) |c| ColorScheme{ .foreground = c.scheme_selected.fg, .background = c.scheme_selected.bg, .border = c.scheme_selected.border } else ColorScheme{ .foreground = 0x0db9d7, .background = 0x1a1b26, .border = 0xad8ee6 };
         const scheme_occupied = if (cfg) |c| ColorScheme{ .foreground = c.scheme_occupied.fg, .background = c.scheme_occupied.bg, .border = c.scheme_occupied.border } else ColorScheme{ .foreground = 0x0db9d7, .background = 0x1a1b26, .border = 0x0db9d7 };
@@ -125,6 +138,7 @@ pub const Bar = struct {
             .pixmap = pixmap,
             .graphics_context = graphics_context,
             .xft_draw = xft_draw,
+            .surface = surface,
             .width = monitor.mon_w,
             .height = bar_height,
             .monitor = monitor,
@@ -143,11 +157,15 @@ pub const Bar = struct {
         monitor.bar_win = window;
         monitor.win_y = monitor.mon_y + bar_height;
         monitor.win_h = monitor.mon_h - bar_height;
+        monitor_mod.invalidate_index();
 
         return bar;
     }
 
     pub fn destroy(self: *Bar, allocator: std.mem.Allocator, display: *xlib.Display) void {
+        if (self.surface) |surface| {
+            surface.destroy();
+        }
         if (self.xft_draw) |xft_draw| {
             xlib.XftDrawDestroy(xft_draw);
         }
@@ -157,10 +175,35 @@ pub const Bar = struct {
         _ = xlib.XFreeGC(display, self.graphics_context);
         _ = xlib.XFreePixmap(display, self.pixmap);
         _ = xlib.c.XDestroyWindow(display, self.window);
+        self.clear_blocks();
         self.blocks.deinit(self.allocator);
         allocator.destroy(self);
     }
 
+    pub fn resize(self: *Bar, display: *xlib.Display, screen: c_int) void {
+        const monitor = self.monitor;
+        _ = xlib.XMoveResizeWindow(display, self.window, monitor.mon_x, monitor.mon_y, @intCast(monitor.mon_w), @intCast(self.height));
+
+        if (monitor.mon_w != self.width) {
+            if (self.xft_draw) |xft_draw| {
+                xlib.XftDrawDestroy(xft_draw);
+            }
+            _ = xlib.XFreePixmap(display, self.pixmap);
+            self.pixmap = xlib.XCreatePixmap(display, self.window, @intCast(monitor.mon_w), @intCast(self.height), @intCast(xlib.XDefaultDepth(display, screen)));
+            self.xft_draw = xlib.XftDrawCreate(display, self.pixmap, xlib.XDefaultVisual(display, screen), xlib.XDefaultColormap(display, screen));
+            if (self.surface) |surface| {
+                surface.destroy();
+                self.surface = if (self.font) |font| shm_surface.Surface.create(self.allocator, display, screen, self.window, monitor.mon_w, self.height, font) else null;
+            }
+            self.width = monitor.mon_w;
+        }
+
+        monitor.win_y = monitor.mon_y + self.height;
+        monitor.win_h = monitor.mon_h - self.height;
+        monitor_mod.invalidate_index();
+        self.needs_redraw = true;
+    }
+
     pub fn add_block(self: *Bar, block: Block) void {
         self.blocks.append(self.allocator, block) catch {};
     }
@@ -169,6 +212,13 @@ pub const Bar = struct {
         self.needs_redraw = true;
     }
 
+    pub fn expose(self: *Bar) void {
+        if (self.surface) |surface| {
+            surface.damage_all();
+        }
+        self.needs_redraw = true;
+    }
+
     pub fn draw(self: *Bar, display: *xlib.Display, tags: []const []const u8) void {
         if (!self.needs_redraw) return;
 
@@ -182,9 +232,10 @@ pub const Bar = struct {
         for (tags, 0..) |tag, index| {
             const tag_mask: u32 = @as(u32, 1) << @intCast(index);
             const is_selected = (current_tags & tag_mask) != 0;
-            const is_occupied = has_clients_on_tag(monitor, tag_mask);
+            const is_occupied = (monitor.occupied_mask & tag_mask) != 0;
+            const is_urgent = (monitor.urgent_mask & tag_mask) != 0;
 
-            const scheme = if (is_selected) self.scheme_selected else if (is_occupied) self.scheme_occupied else self.scheme_normal;
+            const scheme = if (is_urgent) self.scheme_urgent else if (is_selected) self.scheme_selected else if (is_occupied) self.scheme_occupied else self.scheme_normal;
 
             const tag_text_width = self.text_width(display, tag);
             const tag_width = tag_text_width + padding * 2;
@@ -220,18 +271,30 @@ pub const Bar = struct {
             block_x -= padding;
         }
 
-        _ = xlib.XCopyArea(display, self.pixmap, self.window, self.graphics_context, 0, 0, @intCast(self.width), @intCast(self.height), 0, 0);
-        _ = xlib.XSync(display, xlib.False);
+        if (self.surface) |surface| {
+            surface.present(self.window);
+        } else {
+            _ = xlib.XCopyArea(display, self.pixmap, self.window, self.graphics_context, 0, 0, @intCast(self.width), @intCast(self.height), 0, 0);
+            _ = xlib.XSync(display, xlib.False);
+        }
 
         self.needs_redraw = false;
     }
 
     fn fill_rect(self: *Bar, display: *xlib.Display, x: i32, y: i32, width: i32, height: i32, color: c_ulong) void {
+        if (self.surface) |surface| {
+            surface.fill_rect(x, y, width, height, color);
+            return;
+        }
         _ = xlib.XSetForeground(display, self.graphics_context, color);
         _ = xlib.XFillRectangle(display, self.pixmap, self.graphics_context, x, y, @intCast(width), @intCast(height));
     }
 
     fn draw_text(self: *Bar, display: *xlib.Display, x: i32, y: i32, text: []const u8, color: c_ulong) void {
+        if (self.surface) |surface| {
+            surface.draw_text(x, y, text, color);
+            return;
+        }
         if (self.xft_draw == null or self.font == null) return;
 
         var xft_color: xlib.XftColor = undefined;
@@ -252,6 +315,7 @@ pub const Bar = struct {
     }
 
     fn text_width(self: *Bar, display: *xlib.Display, text: []const u8) i32 {
+        if (self.surface) |surface| return surface.text_width(text);
         if (self.font == null) return 0;
 
         var extents: xlib.XGlyphInfo = undefined;
@@ -290,23 +354,26 @@ pub const Bar = struct {
     }
 
     pub fn clear_blocks(self: *Bar) void {
+        for (self.blocks.items) |*block| {
+            block.deinit();
+        }
         self.blocks.clearRetainingCapacity();
     }
 };
 
-fn has_clients_on_tag(monitor: *Monitor, tag_mask: u32) bool {
-    var current = monitor.clients;
-    while (current) |client| {
-        if ((client.tags & tag_mask) != 0) {
-            return true;
-        }
-        current = client.next;
+pub var bars: ?*Bar = null;
+
+pub fn fill_memory_report(report: *memory.Report) void {
+    var current = bars;
+    while (current) |bar| {
+        report.bars += 1;
+        report.blocks += bar.blocks.items.len;
+        report.block_bytes += bar.blocks.capacity * @sizeOf(Block);
+        if (bar.surface) |surface| report.surface_bytes += surface.memory_bytes();
+        current = bar.next;
     }
-    return false;
 }
 
-pub var bars: ?*Bar = null;
-
 pub fn create_bars(allocator: std.mem.Allocator, display: *xlib.Display, screen: c_int) void {
     var current_monitor = monitor_mod.monitors;
     while (current_monitor) |monitor| {
@@ -337,6 +404,24 @@ pub fn invalidate_bars() void {
     }
 }
 
+pub fn refresh_file_blocks(watch: i32, mask: u32) void {
+    var current = bars;
+    while (current) |bar| {
+        for (bar.blocks.items) |*block| {
+            switch (block.data) {
+                .file => |*f| {
+                    if (f.watch != watch) continue;
+                    f.handle_event(mask);
+                    block.refresh();
+                    bar.invalidate();
+                },
+                else => {},
+            }
+        }
+        current = bar.next;
+    }
+}
+
 pub fn destroy_bars(allocator: std.mem.Allocator, display: *xlib.Display) void {
     var current = bars;
     while (current) |bar| {
@@ -347,6 +432,37 @@ pub fn destroy_bars(allocator: std.mem.Allocator, display: *xlib.Display) void {
     bars = null;
 }
 
+pub fn append_bar(bar: *Bar) void {
+    var link: *?*Bar = &bars;
+    while (link.*) |current| {
+        link = &current.next;
+    }
+    link.* = bar;
+}
+
+pub fn remove_bar(allocator: std.mem.Allocator, display: *xlib.Display, bar: *Bar) void {
+    var link: *?*Bar = &bars;
+    while (link.*) |current| {
+        if (current == bar) {
+            link.* = bar.next;
+            break;
+        }
+        link = &current.next;
+    }
+    bar.destroy(allocator, display);
+}
+
+pub fn monitor_to_bar(monitor: *Monitor) ?*Bar {
+    var current = bars;
+    while (current) |bar| {
+        if (bar.monitor == monitor) {
+            return bar;
+        }
+        current = bar.next;
+    }
+    return null;
+}
+
 pub fn window_to_bar(win: xlib.Window) ?*Bar {
     var current = bars;
     while (current) |bar| {
@@ -358,15 +474,15 @@ pub fn window_to_bar(win: xlib.Window) ?*Bar {
     return null;
 }
 
-pub fn force_pulseaudio_update() void {
+pub fn refresh_blocks(block_type: blocks_mod.Block_Type) void {
     var current = bars;
     while (current) |bar| {
         for (bar.blocks.items) |*block| {
-            if (block.data == .pulseaudio) {
-                block.last_update = 0;
+            if (std.meta.activeTag(block.data) == block_type) {
+                block.refresh();
+                bar.invalidate();
             }
         }
-        bar.invalidate();
         current = bar.next;
     }
 }
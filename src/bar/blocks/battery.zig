@@ -1,5 +1,10 @@
 const std = @import("std");
 const format_util = @import("format.zig");
+const uevent = @import("uevent.zig");
+
+pub var sysfs_root: []const u8 = "/sys/class/power_supply";
+
+const safety_interval_secs: u64 = 300;
 
 pub const Battery = struct {
     format_charging: []const u8,
@@ -17,6 +22,7 @@ pub const Battery = struct {
         interval_secs: u64,
         color: c_ulong,
     ) Battery {
+        _ = uevent.open();
         return .{
             .format_charging = format_charging,
             .format_discharging = format_discharging,
@@ -48,7 +54,7 @@ pub const Battery = struct {
     const Status = enum { charging, discharging, full };
 
     fn read_battery_status(self: *Battery, path_buf: *[128]u8) ?Status {
-        const path = std.fmt.bufPrint(path_buf, "/sys/class/power_supply/{s}/status", .{self.battery_name}) catch return null;
+        const path = std.fmt.bufPrint(path_buf, "{s}/{s}/status", .{ sysfs_root, self.battery_name }) catch return null;
 
         const file = std.fs.openFileAbsolute(path, .{}) catch return null;
         defer file.close();
@@ -65,7 +71,7 @@ pub const Battery = struct {
     }
 
     fn read_battery_file(self: *Battery, path_buf: *[128]u8, file_name: []const u8) ?u8 {
-        const path = std.fmt.bufPrint(path_buf, "/sys/class/power_supply/{s}/{s}", .{ self.battery_name, file_name }) catch return null;
+        const path = std.fmt.bufPrint(path_buf, "{s}/{s}/{s}", .{ sysfs_root, self.battery_name, file_name }) catch return null;
 
         const file = std.fs.openFileAbsolute(path, .{}) catch return null;
         defer file.close();
@@ -78,6 +84,9 @@ pub const Battery = struct {
     }
 
     pub fn interval(self: *Battery) u64 {
+        if (uevent.is_active()) {
+            return @max(self.interval_secs, safety_interval_secs);
+        }
         return self.interval_secs;
     }
 
@@ -85,3 +94,46 @@ pub const Battery = struct {
         return self.color;
     }
 };
+
+fn write_supply_file(dir: std.fs.Dir, name: []const u8, contents: []const u8) !void {
+    const file = try dir.createFile(name, .{});
+    defer file.close();
+    try file.writeAll(contents);
+}
+
+test "battery renders each status from a fake sysfs tree" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    try tmp.dir.makePath("BAT0");
+    var bat0 = try tmp.dir.openDir("BAT0", .{});
+    defer bat0.close();
+
+    var root_buffer: [std.fs.max_path_bytes]u8 = undefined;
+    const saved_root = sysfs_root;
+    sysfs_root = try tmp.dir.realpath(".", &root_buffer);
+    defer sysfs_root = saved_root;
+
+    var battery = Battery{
+        .format_charging = "+{}%",
+        .format_discharging = "-{}%",
+        .format_full = "={}%",
+        .battery_name = "BAT0",
+        .interval_secs = 30,
+        .color = 0,
+    };
+    var buffer: [64]u8 = undefined;
+
+    try write_supply_file(bat0, "capacity", "42\n");
+    try write_supply_file(bat0, "status", "Charging\n");
+    try std.testing.expectEqualStrings("+42%", battery.content(&buffer));
+
+    try write_supply_file(bat0, "status", "Discharging\n");
+    try std.testing.expectEqualStrings("-42%", battery.content(&buffer));
+
+    try write_supply_file(bat0, "capacity", "100\n");
+    try write_supply_file(bat0, "status", "Full\n");
+    try std.testing.expectEqualStrings("=100%", battery.content(&buffer));
+
+    try write_supply_file(bat0, "status", "Not charging\n");
+    try std.testing.expectEqualStrings("=100%", battery.content(&buffer));
+}
@@ -5,7 +5,12 @@ pub const Date_Time = @import("datetime.zig").Date_Time;
 pub const Ram = @import("ram.zig").Ram;
 pub const Shell = @import("shell.zig").Shell;
 pub const Battery = @import("battery.zig").Battery;
+pub const uevent = @import("uevent.zig");
 pub const Cpu_Temp = @import("cpu_temp.zig").Cpu_Temp;
+pub const Cpu_Usage = @import("cpu_usage.zig").Cpu_Usage;
+pub const Net_Rate = @import("net_rate.zig").Net_Rate;
+pub const file = @import("file.zig");
+pub const File = file.File;
 pub const pulseaudio = @import("pulseaudio.zig");
 pub const Pulseaudio = pulseaudio.Pulseaudio;
 
@@ -17,12 +22,15 @@ pub const Block_Type = enum {
     battery,
     cpu_temp,
     pulseaudio,
+    cpu_usage,
+    net_rate,
+    file,
 };
 
 pub const Block = struct {
     data: Data,
     last_update: i64,
-    cached_content: [256]u8,
+    cached_content: [512]u8,
     cached_len: usize,
     underline: bool,
 
@@ -34,6 +42,9 @@ pub const Block = struct {
         battery: Battery,
         cpu_temp: Cpu_Temp,
         pulseaudio: Pulseaudio,
+        cpu_usage: Cpu_Usage,
+        net_rate: Net_Rate,
+        file: File,
     };
 
     pub fn init_static(text: []const u8, col: c_ulong, ul: bool) Block {
@@ -88,13 +99,16 @@ pub const Block = struct {
         col: c_ulong,
         ul: bool,
     ) Block {
-        return .{
+        var block = Block{
             .data = .{ .battery = Battery.init(format_charging, format_discharging, format_full, battery_name, interval_secs, col) },
             .last_update = 0,
             .cached_content = undefined,
             .cached_len = 0,
             .underline = ul,
         };
+        block.refresh();
+        block.last_update = std.time.timestamp();
+        return block;
     }
 
     pub fn init_cpu_temp(
@@ -122,13 +136,57 @@ pub const Block = struct {
         col: c_ulong,
         ul: bool,
     ) Block {
-        return .{
+        var block = Block{
             .data = .{ .pulseaudio = Pulseaudio.init(format_muted, format_low, format_medium, format_high, interval_secs, col) },
             .last_update = 0,
             .cached_content = undefined,
             .cached_len = 0,
             .underline = ul,
         };
+        block.refresh();
+        return block;
+    }
+
+    pub fn init_cpu_usage(format: []const u8, per_core: bool, interval_secs: u64, col: c_ulong, ul: bool) Block {
+        return .{
+            .data = .{ .cpu_usage = Cpu_Usage.init(format, per_core, interval_secs, col) },
+            .last_update = 0,
+            .cached_content = undefined,
+            .cached_len = 0,
+            .underline = ul,
+        };
+    }
+
+    pub fn init_net_rate(format: []const u8, interface: []const u8, interval_secs: u64, col: c_ulong, ul: bool) Block {
+        return .{
+            .data = .{ .net_rate = Net_Rate.init(format, interface, interval_secs, col) },
+            .last_update = 0,
+            .cached_content = undefined,
+            .cached_len = 0,
+            .underline = ul,
+        };
+    }
+
+    pub fn init_file(format: []const u8, path: []const u8, col: c_ulong, ul: bool) Block {
+        var block = Block{
+            .data = .{ .file = File.init(format, path, col) },
+            .last_update = 0,
+            .cached_content = undefined,
+            .cached_len = 0,
+            .underline = ul,
+        };
+        block.refresh();
+        block.last_update = std.time.timestamp();
+        return block;
+    }
+
+    pub fn deinit(self: *Block) void {
+        switch (self.data) {
+            .cpu_usage => |*c| c.deinit(),
+            .net_rate => |*n| n.deinit(),
+            .file => |*f| f.deinit(),
+            else => {},
+        }
     }
 
     pub fn update(self: *Block) bool {
@@ -141,7 +199,11 @@ pub const Block = struct {
         }
 
         self.last_update = now;
+        self.refresh();
+        return true;
+    }
 
+    pub fn refresh(self: *Block) void {
         const result = switch (self.data) {
             .static => |*s| s.content(&self.cached_content),
             .datetime => |*d| d.content(&self.cached_content),
@@ -150,10 +212,12 @@ pub const Block = struct {
             .battery => |*b| b.content(&self.cached_content),
             .cpu_temp => |*c| c.content(&self.cached_content),
             .pulseaudio => |*p| p.content(&self.cached_content),
+            .cpu_usage => |*c| c.content(&self.cached_content),
+            .net_rate => |*n| n.content(&self.cached_content),
+            .file => |*f| f.content(&self.cached_content),
         };
 
         self.cached_len = result.len;
-        return true;
     }
 
     pub fn interval(self: *Block) u64 {
@@ -165,6 +229,9 @@ pub const Block = struct {
             .battery => |*b| b.interval(),
             .cpu_temp => |*c| c.interval(),
             .pulseaudio => |*p| p.interval(),
+            .cpu_usage => |*c| c.interval(),
+            .net_rate => |*n| n.interval(),
+            .file => |*f| f.interval(),
         };
     }
 
@@ -177,6 +244,9 @@ pub const Block = struct {
             .battery => |b| b.color,
             .cpu_temp => |c| c.color,
             .pulseaudio => |p| p.color,
+            .cpu_usage => |c| c.color,
+            .net_rate => |n| n.color,
+            .file => |f| f.color,
         };
     }
 
@@ -0,0 +1,188 @@
+const std = @import("std");
+const format_util = @import("format.zig");
+const scan = @import("scan.zig");
+
+const max_cores: usize = 1024;
+const max_columns: usize = 128;
+const initial_read_size: usize = 64 * 1024;
+const levels = [_][]const u8{ "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█" };
+
+const Sample = struct {
+    total: u64 = 0,
+    idle: u64 = 0,
+};
+
+const State = struct {
+    stat: scan.Proc_File,
+    total: Sample,
+    total_percent: u8,
+    cores: [max_cores]Sample,
+    core_percent: [max_cores]u8,
+    core_count: usize,
+
+    fn reset(self: *State) void {
+        self.total = .{};
+        self.total_percent = 0;
+        self.cores = [_]Sample{.{}} ** max_cores;
+        self.core_percent = [_]u8{0} ** max_cores;
+        self.core_count = 0;
+    }
+
+    fn sample(self: *State) bool {
+        const data = self.stat.read() orelse return false;
+        return self.parse(data);
+    }
+
+    fn parse(self: *State, data: []const u8) bool {
+        var scanner = scan.Scanner.init(data);
+
+        var line_index: usize = 0;
+        while (scanner.starts_with("cpu")) : (line_index += 1) {
+            scanner.skip_word();
+
+            var fields: [8]u64 = undefined;
+            for (&fields) |*field| {
+                field.* = scanner.next_u64() orelse 0;
+            }
+            scanner.skip_line();
+
+            var current = Sample{ .idle = fields[3] + fields[4] };
+            for (fields) |field| {
+                current.total += field;
+            }
+
+            if (line_index == 0) {
+                self.total_percent = usage_percent(self.total, current);
+                self.total = current;
+            } else if (line_index - 1 < max_cores) {
+                const core = line_index - 1;
+                self.core_percent[core] = usage_percent(self.cores[core], current);
+                self.cores[core] = current;
+            }
+        }
+
+        self.core_count = @min(line_index -| 1, max_cores);
+        return line_index > 0;
+    }
+
+    fn render_sparkline(self: *State, out: []u8) []const u8 {
+        const count = self.core_count;
+        if (count == 0) return out[0..0];
+
+        const columns = @min(count, max_columns);
+        const per_column = (count + columns - 1) / columns;
+
+        var len: usize = 0;
+        var column_start: usize = 0;
+        while (column_start < count) : (column_start += per_column) {
+            const column_end = @min(column_start + per_column, count);
+            var sum: usize = 0;
+            for (self.core_percent[column_start..column_end]) |percent| {
+                sum += percent;
+            }
+            const average = sum / (column_end - column_start);
+            const glyph = levels[@min(average * levels.len / 100, levels.len - 1)];
+            if (len + glyph.len > out.len) break;
+            @memcpy(out[len..][0..glyph.len], glyph);
+            len += glyph.len;
+        }
+        return out[0..len];
+    }
+};
+
+fn usage_percent(previous: Sample, current: Sample) u8 {
+    const total_delta = current.total -| previous.total;
+    if (total_delta == 0) return 0;
+    const busy_delta = total_delta -| (current.idle -| previous.idle);
+    return @intCast((busy_delta * 100 + total_delta / 2) / total_delta);
+}
+
+pub const Cpu_Usage = struct {
+    format: []const u8,
+    per_core: bool,
+    interval_secs: u64,
+    color: c_ulong,
+    state: ?*State,
+
+    pub fn init(format: []const u8, per_core: bool, interval_secs: u64, color: c_ulong) Cpu_Usage {
+        var self = Cpu_Usage{
+            .format = format,
+            .per_core = per_core,
+            .interval_secs = interval_secs,
+            .color = color,
+            .state = null,
+        };
+
+        var stat = scan.Proc_File.open("/proc/stat", initial_read_size) orelse return self;
+        const state = std.heap.page_allocator.create(State) catch {
+            stat.close();
+            return self;
+        };
+        state.stat = stat;
+        state.reset();
+        self.state = state;
+        return self;
+    }
+
+    pub fn deinit(self: *Cpu_Usage) void {
+        const state = self.state orelse return;
+        state.stat.close();
+        std.heap.page_allocator.destroy(state);
+        self.state = null;
+    }
+
+    pub fn content(self: *Cpu_Usage, buffer: []u8) []const u8 {
+        const state = self.state orelse return buffer[0..0];
+        if (!state.sample()) return buffer[0..0];
+
+        var total_buf: [8]u8 = undefined;
+        const total_str = std.fmt.bufPrint(&total_buf, "{d}", .{state.total_percent}) catch return buffer[0..0];
+
+        if (!self.per_core) {
+            return format_util.substitute(self.format, total_str, buffer);
+        }
+
+        var spark_buf: [max_columns * 3]u8 = undefined;
+        const spark_str = state.render_sparkline(&spark_buf);
+        return format_util.substitute_multi(self.format, &.{ total_str, spark_str }, buffer);
+    }
+
+    pub fn interval(self: *Cpu_Usage) u64 {
+        return self.interval_secs;
+    }
+
+    pub fn get_color(self: *Cpu_Usage) c_ulong {
+        return self.color;
+    }
+};
+
+test "cpu usage parses a captured /proc/stat sample" {
+    const first =
+        \\cpu  100 0 100 700 100 0 0 0 0 0
+        \\cpu0 50 0 50 350 50 0 0 0 0 0
+        \\cpu1 50 0 50 350 50 0 0 0 0 0
+        \\intr 123456 0 0 0
+        \\ctxt 987654
+        \\
+    ;
+    const second =
+        \\cpu  200 0 200 1300 100 0 0 0 0 0
+        \\cpu0 150 0 50 350 50 0 0 0 0 0
+        \\cpu1 50 0 150 950 50 0 0 0 0 0
+        \\intr 123999 0 0 0
+        \\ctxt 987999
+        \\
+    ;
+
+    const state = try std.testing.allocator.create(State);
+    defer std.testing.allocator.destroy(state);
+    state.reset();
+
+    try std.testing.expect(state.parse(first));
+    try std.testing.expectEqual(@as(usize, 2), state.core_count);
+    try std.testing.expect(state.parse(second));
+    try std.testing.expectEqual(@as(u8, 25), state.total_percent);
+    try std.testing.expectEqual(@as(u8, 100), state.core_percent[0]);
+    try std.testing.expectEqual(@as(u8, 14), state.core_percent[1]);
+    try std.testing.expect(!state.parse("intr 1 2 3\n"));
+}
@@ -0,0 +1,168 @@
+const std = @import("std");
+const linux = std.os.linux;
+const format_util = @import("format.zig");
+
+const watch_mask: u32 = linux.IN.CLOSE_WRITE | linux.IN.MODIFY | linux.IN.DELETE_SELF | linux.IN.MOVE_SELF;
+const rewatch_mask: u32 = linux.IN.IGNORED | linux.IN.DELETE_SELF | linux.IN.MOVE_SELF;
+const retry_secs: u64 = 5;
+
+var inotify_fd: i32 = -1;
+var watch_refs: std.AutoHashMapUnmanaged(i32, u32) = .{};
+
+fn ensure_inotify() ?i32 {
+    if (inotify_fd >= 0) return inotify_fd;
+    inotify_fd = std.posix.inotify_init1(linux.IN.NONBLOCK | linux.IN.CLOEXEC) catch return null;
+    return inotify_fd;
+}
+
+fn acquire_watch(path: []const u8) i32 {
+    const fd = ensure_inotify() orelse return -1;
+    const watch = std.posix.inotify_add_watch(fd, path, watch_mask) catch return -1;
+    if (watch_refs.getPtr(watch)) |count| {
+        count.* += 1;
+        return watch;
+    }
+    watch_refs.put(std.heap.page_allocator, watch, 1) catch {
+        _ = linux.inotify_rm_watch(fd, watch);
+        return -1;
+    };
+    return watch;
+}
+
+fn release_watch(watch: i32) void {
+    if (watch < 0) return;
+    const count = watch_refs.getPtr(watch) orelse return;
+    count.* -= 1;
+    if (count.* > 0) return;
+    _ = watch_refs.remove(watch);
+    if (inotify_fd >= 0) {
+        _ = linux.inotify_rm_watch(inotify_fd, watch);
+    }
+}
+
+pub fn get_fd() ?i32 {
+    if (inotify_fd < 0) return null;
+    return inotify_fd;
+}
+
+pub const Watch_Event = struct {
+    watch: i32,
+    mask: u32,
+};
+
+pub const Event_Reader = struct {
+    buffer: [4096]u8 align(@alignOf(linux.inotify_event)) = undefined,
+    len: usize = 0,
+    offset: usize = 0,
+
+    pub fn next(self: *Event_Reader) ?Watch_Event {
+        if (self.offset + @sizeOf(linux.inotify_event) > self.len) {
+            if (inotify_fd < 0) return null;
+            self.len = std.posix.read(inotify_fd, &self.buffer) catch return null;
+            self.offset = 0;
+            if (self.len < @sizeOf(linux.inotify_event)) return null;
+        }
+        const event: *const linux.inotify_event = @ptrCast(@alignCast(&self.buffer[self.offset]));
+        self.offset += @sizeOf(linux.inotify_event) + event.len;
+        return .{ .watch = event.wd, .mask = event.mask };
+    }
+};
+
+pub const File = struct {
+    format: []const u8,
+    path: []const u8,
+    color: c_ulong,
+    watch: i32,
+
+    pub fn init(format: []const u8, path: []const u8, color: c_ulong) File {
+        var self = File{
+            .format = format,
+            .path = path,
+            .color = color,
+            .watch = -1,
+        };
+        self.add_watch();
+        return self;
+    }
+
+    pub fn deinit(self: *File) void {
+        release_watch(self.watch);
+        self.watch = -1;
+    }
+
+    fn add_watch(self: *File) void {
+        if (self.path.len == 0) return;
+        self.watch = acquire_watch(self.path);
+    }
+
+    pub fn handle_event(self: *File, mask: u32) void {
+        if ((mask & rewatch_mask) != 0) {
+            release_watch(self.watch);
+            self.watch = -1;
+            self.add_watch();
+        }
+    }
+
+    pub fn content(self: *File, buffer: []u8) []const u8 {
+        if (self.watch < 0) {
+            self.add_watch();
+        }
+
+        const file = std.fs.cwd().openFile(self.path, .{}) catch return buffer[0..0];
+        defer file.close();
+
+        var read_buffer: [256]u8 = undefined;
+        const len = file.read(&read_buffer) catch return buffer[0..0];
+        var end = len;
+        if (std.mem.indexOfScalar(u8, read_buffer[0..len], '\n')) |newline| {
+            end = newline;
+        }
+        const value = std.mem.trim(u8, read_buffer[0..end], " \r\t");
+
+        return format_util.substitute(self.format, value, buffer);
+    }
+
+    pub fn interval(self: *File) u64 {
+        if (self.watch < 0) return retry_secs;
+        return 0;
+    }
+
+    pub fn get_color(self: *File) c_ulong {
+        return self.color;
+    }
+};
+
+test "file blocks on the same path share one reference-counted watch" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    try tmp.dir.writeFile(.{ .sub_path = "value", .data = "1\n" });
+
+    var path_buffer: [std.fs.max_path_bytes]u8 = undefined;
+    const path = try tmp.dir.realpath("value", &path_buffer);
+
+    var first = File.init("{}", path, 0);
+    var second = File.init("{}", path, 0);
+    try std.testing.expect(first.watch >= 0);
+    try std.testing.expectEqual(first.watch, second.watch);
+
+    first.deinit();
+    try std.testing.expectEqual(@as(?u32, 1), watch_refs.get(second.watch));
+
+    var buffer: [16]u8 = undefined;
+    try tmp.dir.writeFile(.{ .sub_path = "value", .data = "2\n" });
+    var reader = Event_Reader{};
+    const event = reader.next() orelse return error.TestExpectedEvent;
+    try std.testing.expectEqual(second.watch, event.watch);
+    try std.testing.expectEqualStrings("2", second.content(&buffer));
+
+    try tmp.dir.rename("value", "value.bak");
+    try tmp.dir.writeFile(.{ .sub_path = "value", .data = "3\n" });
+    const moved = second.watch;
+    second.handle_event(linux.IN.MOVE_SELF);
+    try std.testing.expect(second.watch >= 0 and second.watch != moved);
+    try std.testing.expect(watch_refs.get(moved) == null);
+    try std.testing.expectEqualStrings("3", second.content(&buffer));
+
+    second.deinit();
+    try std.testing.expectEqual(@as(u32, 0), watch_refs.count());
+}
@@ -0,0 +1,147 @@
+const std = @import("std");
+const format_util = @import("format.zig");
+const scan = @import("scan.zig");
+
+const initial_read_size: usize = 16 * 1024;
+
+const Totals = struct {
+    rx: u64 = 0,
+    tx: u64 = 0,
+};
+
+pub const Net_Rate = struct {
+    format: []const u8,
+    interface: []const u8,
+    interval_secs: u64,
+    color: c_ulong,
+    dev: ?scan.Proc_File,
+    previous_rx: u64,
+    previous_tx: u64,
+    previous_time: i128,
+
+    pub fn init(format: []const u8, interface: []const u8, interval_secs: u64, color: c_ulong) Net_Rate {
+        return .{
+            .format = format,
+            .interface = interface,
+            .interval_secs = interval_secs,
+            .color = color,
+            .dev = scan.Proc_File.open("/proc/net/dev", initial_read_size),
+            .previous_rx = 0,
+            .previous_tx = 0,
+            .previous_time = 0,
+        };
+    }
+
+    pub fn deinit(self: *Net_Rate) void {
+        if (self.dev) |*dev| {
+            dev.close();
+        }
+        self.dev = null;
+    }
+
+    pub fn content(self: *Net_Rate, buffer: []u8) []const u8 {
+        const dev = if (self.dev) |*file| file else return buffer[0..0];
+        const data = dev.read() orelse return buffer[0..0];
+        const now = std.time.nanoTimestamp();
+        const totals = sum_interfaces(data, self.interface);
+
+        const elapsed_ns = now - self.previous_time;
+        const had_previous = self.previous_time != 0;
+        const rx_delta = totals.rx -| self.previous_rx;
+        const tx_delta = totals.tx -| self.previous_tx;
+        self.previous_rx = totals.rx;
+        self.previous_tx = totals.tx;
+        self.previous_time = now;
+
+        var rx_rate: u64 = 0;
+        var tx_rate: u64 = 0;
+        if (had_previous and elapsed_ns > 0) {
+            rx_rate = per_second(rx_delta, elapsed_ns);
+            tx_rate = per_second(tx_delta, elapsed_ns);
+        }
+
+        var val_bufs: [2][16]u8 = undefined;
+        const rx_str = format_rate(rx_rate, &val_bufs[0]);
+        const tx_str = format_rate(tx_rate, &val_bufs[1]);
+        return format_util.substitute_multi(self.format, &.{ rx_str, tx_str }, buffer);
+    }
+
+    pub fn interval(self: *Net_Rate) u64 {
+        return self.interval_secs;
+    }
+
+    pub fn get_color(self: *Net_Rate) c_ulong {
+        return self.color;
+    }
+};
+
+fn sum_interfaces(data: []const u8, interface: []const u8) Totals {
+    var totals = Totals{};
+    var scanner = scan.Scanner.init(data);
+    scanner.skip_line();
+    scanner.skip_line();
+    while (!scanner.at_end()) {
+        scanner.skip_spaces();
+        const name = scanner.take_until(':');
+        const rx = scanner.next_u64() orelse 0;
+        scanner.skip_u64s(7);
+        const tx = scanner.next_u64() orelse 0;
+        scanner.skip_line();
+
+        const selected = if (interface.len > 0)
+            std.mem.eql(u8, name, interface)
+        else
+            !std.mem.eql(u8, name, "lo");
+        if (selected) {
+            totals.rx += rx;
+            totals.tx += tx;
+        }
+    }
+    return totals;
+}
+
+fn per_second(delta: u64, elapsed_ns: i128) u64 {
+    const rate = @divTrunc(@as(i128, delta) * std.time.ns_per_s, elapsed_ns);
+    return @intCast(@min(rate, std.math.maxInt(u64)));
+}
+
+fn format_rate(bytes_per_sec: u64, buf: []u8) []const u8 {
+    const units = [_][]const u8{ "B", "K", "M", "G" };
+    if (bytes_per_sec < 1024) {
+        return std.fmt.bufPrint(buf, "{d}{s}", .{ bytes_per_sec, units[0] }) catch buf[0..0];
+    }
+
+    var value: f64 = @floatFromInt(bytes_per_sec);
+    var unit: usize = 0;
+    while (value >= 1024.0 and unit < units.len - 1) : (unit += 1) {
+        value /= 1024.0;
+    }
+    return std.fmt.bufPrint(buf, "{d:.1}{s}", .{ value, units[unit] }) catch buf[0..0];
+}
+
+test "net rate sums a captured /proc/net/dev sample" {
+    const sample =
+        \\Inter-|   Receive                                                |  Transmit
+        \\ face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed
+        \\    lo: 5000000   40000    0    0    0     0          0         0  5000000   40000    0    0    0     0       0          0
+        \\  eth0: 1234567    9000    0    0    0     0          0        12   765432    8000    0    0    0     0       0          0
+        \\docker0:     100       2    0    0    0     0          0         0      200       3    0    0    0     0       0          0
+        \\veth1a2b3c:123 1 0 0 0 0 0 0 42 1 0 0 0 0 0 0
+        \\
+    ;
+
+    const eth0 = sum_interfaces(sample, "eth0");
+    try std.testing.expectEqual(@as(u64, 1234567), eth0.rx);
+    try std.testing.expectEqual(@as(u64, 765432), eth0.tx);
+
+    const veth = sum_interfaces(sample, "veth1a2b3c");
+    try std.testing.expectEqual(@as(u64, 123), veth.rx);
+    try std.testing.expectEqual(@as(u64, 42), veth.tx);
+
+    const docker = sum_interfaces(sample, "docker0");
+    try std.testing.expectEqual(@as(u64, 100), docker.rx);
+    try std.testing.expectEqual(@as(u64, 200), docker.tx);
+
+    try std.testing.expectEqual(Totals{}, sum_interfaces(sample, "wlan0"));
+    try std.testing.expectEqual(Totals{ .rx = 1234790, .tx = 765674 }, sum_interfaces(sample, ""));
+}
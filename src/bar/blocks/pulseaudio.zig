@@ -5,12 +5,37 @@ const pulse = @cImport({
     @cInclude("pulse/pulseaudio.h");
 });
 
-var global_volume: u8 = 0;
-var global_muted: bool = false;
+const linux = std.os.linux;
+
+const muted_bit: u32 = 1 << 8;
+
+var published_state = std.atomic.Value(u32).init(0);
 var current_cvolume: pulse.pa_cvolume = undefined;
+var cvolume_valid: bool = false;
 var initialized: bool = false;
 var pa_ml: ?*pulse.pa_threaded_mainloop = null;
 var pa_ctx: ?*pulse.pa_context = null;
+var event_fd: i32 = -1;
+
+fn volume_percent(cvolume: *const pulse.pa_cvolume) u8 {
+    const avg = pulse.pa_cvolume_avg(cvolume);
+    const pct = (avg * 100 + pulse.PA_VOLUME_NORM / 2) / pulse.PA_VOLUME_NORM;
+    return @intCast(@min(pct, 100));
+}
+
+fn publish(volume: u8, muted: bool) void {
+    const state: u32 = @as(u32, volume) | (if (muted) muted_bit else 0);
+    const previous = published_state.swap(state, .acq_rel);
+    if (previous != state) {
+        signal_event();
+    }
+}
+
+fn signal_event() void {
+    if (event_fd < 0) return;
+    const one: u64 = 1;
+    _ = std.posix.write(event_fd, std.mem.asBytes(&one)) catch {};
+}
 
 fn sink_info_cb(
     ctx: ?*pulse.pa_context,
@@ -23,14 +48,25 @@ fn sink_info_cb(
     if (eol != 0 or info == null) return;
 
     if (info) |sink| {
-        const avg = pulse.pa_cvolume_avg(&sink.volume);
-        const pct = (avg * 100 + pulse.PA_VOLUME_NORM / 2) / pulse.PA_VOLUME_NORM;
-        global_volume = @intCast(@min(pct, 100));
-        global_muted = sink.mute != 0;
         current_cvolume = sink.volume;
+        cvolume_valid = true;
+        publish(volume_percent(&sink.volume), sink.mute != 0);
+    }
+}
+
+fn request_sink_info(ctx: ?*pulse.pa_context) void {
+    const op = pulse.pa_context_get_sink_info_by_name(ctx, "@DEFAULT_SINK@", sink_info_cb, null);
+    if (op != null) {
+        pulse.pa_operation_unref(op);
     }
 }
 
+fn set_done_cb(ctx: ?*pulse.pa_context, success: c_int, userdata: ?*anyopaque) callconv(.c) void {
+    _ = success;
+    _ = userdata;
+    request_sink_info(ctx);
+}
+
 fn subscribe_cb(
     ctx: ?*pulse.pa_context,
     event_type: pulse.pa_subscription_event_type_t,
@@ -41,7 +77,7 @@ fn subscribe_cb(
     _ = userdata;
     const facility = event_type & pulse.PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
     if (facility == pulse.PA_SUBSCRIPTION_EVENT_SINK or facility == pulse.PA_SUBSCRIPTION_EVENT_SERVER) {
-        _ = pulse.pa_context_get_sink_info_by_name(ctx, "@DEFAULT_SINK@", sink_info_cb, null);
+        request_sink_info(ctx);
     }
 }
 
@@ -50,14 +86,19 @@ fn context_state_cb(ctx: ?*pulse.pa_context, userdata: ?*anyopaque) callconv(.c)
     const state = pulse.pa_context_get_state(ctx);
     if (state == pulse.PA_CONTEXT_READY) {
         pulse.pa_context_set_subscribe_callback(ctx, subscribe_cb, null);
-        _ = pulse.pa_context_subscribe(ctx, pulse.PA_SUBSCRIPTION_MASK_SINK | pulse.PA_SUBSCRIPTION_MASK_SERVER, null, null);
-        _ = pulse.pa_context_get_sink_info_by_name(ctx, "@DEFAULT_SINK@", sink_info_cb, null);
+        const op = pulse.pa_context_subscribe(ctx, pulse.PA_SUBSCRIPTION_MASK_SINK | pulse.PA_SUBSCRIPTION_MASK_SERVER, null, null);
+        if (op != null) {
+            pulse.pa_operation_unref(op);
+        }
+        request_sink_info(ctx);
     }
 }
 
 pub fn init_pa() void {
     if (initialized) return;
 
+    event_fd = std.posix.eventfd(0, linux.EFD.CLOEXEC | linux.EFD.NONBLOCK) catch -1;
+
     pa_ml = pulse.pa_threaded_mainloop_new();
     if (pa_ml == null) return;
 
@@ -93,11 +134,35 @@ pub fn deinit_pa() void {
         }
         pulse.pa_threaded_mainloop_free(ml);
     }
+    if (event_fd >= 0) {
+        std.posix.close(event_fd);
+    }
     pa_ml = null;
     pa_ctx = null;
+    event_fd = -1;
     initialized = false;
 }
 
+pub fn get_event_fd() ?i32 {
+    if (event_fd < 0) return null;
+    return event_fd;
+}
+
+pub fn consume_event() bool {
+    if (event_fd < 0) return false;
+    var counter: u64 = 0;
+    const len = std.posix.read(event_fd, std.mem.asBytes(&counter)) catch return false;
+    return len == @sizeOf(u64) and counter > 0;
+}
+
+pub fn get_volume() u8 {
+    return @truncate(published_state.load(.acquire));
+}
+
+pub fn is_muted() bool {
+    return (published_state.load(.acquire) & muted_bit) != 0;
+}
+
 pub fn adjust_volume(delta: i32) void {
     const ml = pa_ml orelse return;
     const ctx = pa_ctx orelse return;
@@ -105,23 +170,23 @@ pub fn adjust_volume(delta: i32) void {
     pulse.pa_threaded_mainloop_lock(ml);
     defer pulse.pa_threaded_mainloop_unlock(ml);
 
-    if (pulse.pa_context_get_state(ctx) != pulse.PA_CONTEXT_READY) return;
+    if (pulse.pa_context_get_state(ctx) != pulse.PA_CONTEXT_READY or !cvolume_valid) return;
 
-    var vol = current_cvolume;
     const step: u32 = @intCast(@abs(delta));
     const change = (pulse.PA_VOLUME_NORM * step) / 100;
 
     if (delta > 0) {
-        _ = pulse.pa_cvolume_inc_clamp(&vol, change, pulse.PA_VOLUME_NORM);
+        _ = pulse.pa_cvolume_inc_clamp(&current_cvolume, change, pulse.PA_VOLUME_NORM);
     } else {
-        _ = pulse.pa_cvolume_dec(&vol, change);
+        _ = pulse.pa_cvolume_dec(&current_cvolume, change);
     }
 
-    const avg = pulse.pa_cvolume_avg(&vol);
-    const pct = (avg * 100 + pulse.PA_VOLUME_NORM / 2) / pulse.PA_VOLUME_NORM;
-    global_volume = @intCast(@min(pct, 100));
+    publish(volume_percent(&current_cvolume), is_muted());
 
-    _ = pulse.pa_context_set_sink_volume_by_name(ctx, "@DEFAULT_SINK@", &vol, null, null);
+    const op = pulse.pa_context_set_sink_volume_by_name(ctx, "@DEFAULT_SINK@", &current_cvolume, set_done_cb, null);
+    if (op != null) {
+        pulse.pa_operation_unref(op);
+    }
 }
 
 pub fn toggle_mute() void {
@@ -133,9 +198,14 @@ pub fn toggle_mute() void {
 
     if (pulse.pa_context_get_state(ctx) != pulse.PA_CONTEXT_READY) return;
 
-    global_muted = !global_muted;
-    const new_mute: c_int = if (global_muted) 1 else 0;
-    _ = pulse.pa_context_set_sink_mute_by_name(ctx, "@DEFAULT_SINK@", new_mute, null, null);
+    const new_muted = !is_muted();
+    publish(get_volume(), new_muted);
+
+    const new_mute: c_int = if (new_muted) 1 else 0;
+    const op = pulse.pa_context_set_sink_mute_by_name(ctx, "@DEFAULT_SINK@", new_mute, set_done_cb, null);
+    if (op != null) {
+        pulse.pa_operation_unref(op);
+    }
 }
 
 pub const Pulseaudio = struct {
@@ -166,22 +236,24 @@ pub const Pulseaudio = struct {
     }
 
     pub fn content(self: *Pulseaudio, buffer: []u8) []const u8 {
-        const format = if (global_muted or global_volume == 0)
+        const volume = get_volume();
+        const format = if (is_muted() or volume == 0)
             self.format_muted
-        else if (global_volume <= 33)
+        else if (volume <= 33)
             self.format_low
-        else if (global_volume <= 66)
+        else if (volume <= 66)
             self.format_medium
         else
             self.format_high;
 
         var vol_buf: [8]u8 = undefined;
-        const vol_str = std.fmt.bufPrint(&vol_buf, "{d}", .{global_volume}) catch return buffer[0..0];
+        const vol_str = std.fmt.bufPrint(&vol_buf, "{d}", .{volume}) catch return buffer[0..0];
 
         return format_util.substitute(format, vol_str, buffer);
     }
 
     pub fn interval(self: *Pulseaudio) u64 {
+        if (event_fd >= 0) return 0;
         return self.interval_secs;
     }
 
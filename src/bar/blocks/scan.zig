@@ -0,0 +1,137 @@
+const std = @import("std");
+
+const max_read_size: usize = 4 * 1024 * 1024;
+
+pub const Proc_File = struct {
+    file: std.fs.File,
+    buffer: []u8,
+
+    pub fn open(path: []const u8, initial_size: usize) ?Proc_File {
+        const file = std.fs.openFileAbsolute(path, .{}) catch return null;
+        const buffer = std.heap.page_allocator.alloc(u8, initial_size) catch {
+            file.close();
+            return null;
+        };
+        return .{ .file = file, .buffer = buffer };
+    }
+
+    pub fn close(self: *Proc_File) void {
+        self.file.close();
+        std.heap.page_allocator.free(self.buffer);
+    }
+
+    pub fn read(self: *Proc_File) ?[]const u8 {
+        var len: usize = 0;
+        while (true) {
+            if (len == self.buffer.len) {
+                if (self.buffer.len >= max_read_size) break;
+                self.buffer = std.heap.page_allocator.realloc(self.buffer, self.buffer.len * 2) catch break;
+            }
+            const received = self.file.pread(self.buffer[len..], len) catch return null;
+            if (received == 0) return self.buffer[0..len];
+            len += received;
+        }
+        const complete = std.mem.lastIndexOfScalar(u8, self.buffer[0..len], '\n') orelse return null;
+        return self.buffer[0 .. complete + 1];
+    }
+};
+
+pub const Scanner = struct {
+    data: []const u8,
+    pos: usize = 0,
+
+    pub fn init(data: []const u8) Scanner {
+        return .{ .data = data };
+    }
+
+    pub fn at_end(self: *const Scanner) bool {
+        return self.pos >= self.data.len;
+    }
+
+    pub fn starts_with(self: *const Scanner, prefix: []const u8) bool {
+        if (self.data.len - self.pos < prefix.len) return false;
+        for (prefix, 0..) |char, index| {
+            if (self.data[self.pos + index] != char) return false;
+        }
+        return true;
+    }
+
+    pub fn skip_spaces(self: *Scanner) void {
+        while (self.pos < self.data.len and (self.data[self.pos] == ' ' or self.data[self.pos] == '\t')) {
+            self.pos += 1;
+        }
+    }
+
+    pub fn skip_line(self: *Scanner) void {
+        while (self.pos < self.data.len and self.data[self.pos] != '\n') {
+            self.pos += 1;
+        }
+        if (self.pos < self.data.len) {
+            self.pos += 1;
+        }
+    }
+
+    pub fn skip_word(self: *Scanner) void {
+        while (self.pos < self.data.len) : (self.pos += 1) {
+            switch (self.data[self.pos]) {
+                ' ', '\t', '\n' => return,
+                else => {},
+            }
+        }
+    }
+
+    pub fn take_until(self: *Scanner, delimiter: u8) []const u8 {
+        const start = self.pos;
+        while (self.pos < self.data.len and self.data[self.pos] != delimiter and self.data[self.pos] != '\n') {
+            self.pos += 1;
+        }
+        const taken = self.data[start..self.pos];
+        if (self.pos < self.data.len and self.data[self.pos] == delimiter) {
+            self.pos += 1;
+        }
+        return taken;
+    }
+
+    pub fn next_u64(self: *Scanner) ?u64 {
+        self.skip_spaces();
+        if (self.pos >= self.data.len) return null;
+
+        var digit = self.data[self.pos] -% '0';
+        if (digit > 9) return null;
+
+        var value: u64 = 0;
+        while (digit <= 9) {
+            value = value *% 10 +% digit;
+            self.pos += 1;
+            if (self.pos >= self.data.len) break;
+            digit = self.data[self.pos] -% '0';
+        }
+        return value;
+    }
+
+    pub fn skip_u64s(self: *Scanner, count: usize) void {
+        var remaining = count;
+        while (remaining > 0) : (remaining -= 1) {
+            _ = self.next_u64() orelse return;
+        }
+    }
+};
+
+test "proc file reads past the initial buffer" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var expected: [1000]u8 = undefined;
+    for (&expected, 0..) |*char, index| {
+        char.* = if (index % 50 == 49) '\n' else 'a' + @as(u8, @intCast(index % 26));
+    }
+    try tmp.dir.writeFile(.{ .sub_path = "stat", .data = &expected });
+
+    var path_buffer: [std.fs.max_path_bytes]u8 = undefined;
+    const path = try tmp.dir.realpath("stat", &path_buffer);
+    var proc_file = Proc_File.open(path, 16) orelse return error.TestOpenFailed;
+    defer proc_file.close();
+
+    try std.testing.expectEqualStrings(&expected, proc_file.read() orelse return error.TestReadFailed);
+    try std.testing.expectEqualStrings(&expected, proc_file.read() orelse return error.TestReadFailed);
+}
@@ -1,5 +1,5 @@
-const std = @import("std");
 const format_util = @import("format.zig");
+const spawn = @import("../../spawn.zig");
 
 pub const Shell = struct {
     format: []const u8,
@@ -18,16 +18,9 @@ pub const Shell = struct {
 
     pub fn content(self: *Shell, buffer: []u8) []const u8 {
         var cmd_output: [256]u8 = undefined;
-        const result = std.process.Child.run(.{
-            .allocator = std.heap.page_allocator,
-            .argv = &.{ "/bin/sh", "-c", self.command },
-        }) catch return buffer[0..0];
-        defer std.heap.page_allocator.free(result.stdout);
-        defer std.heap.page_allocator.free(result.stderr);
-
-        var cmd_len = @min(result.stdout.len, cmd_output.len);
-        @memcpy(cmd_output[0..cmd_len], result.stdout[0..cmd_len]);
+        const output = spawn.capture(self.command, &cmd_output) orelse return buffer[0..0];
 
+        var cmd_len = output.len;
         while (cmd_len > 0 and (cmd_output[cmd_len - 1] == '\n' or cmd_output[cmd_len - 1] == '\r')) {
             cmd_len -= 1;
         }
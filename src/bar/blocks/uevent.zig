@@ -0,0 +1,129 @@
+const std = @import("std");
+const linux = std.os.linux;
+
+pub const Event = struct {
+    action: []const u8 = "",
+    subsystem: []const u8 = "",
+    supply_name: []const u8 = "",
+};
+
+const kernel_group: u32 = 1;
+
+var source_fd: i32 = -1;
+var owns_source: bool = false;
+
+pub fn open() ?i32 {
+    if (source_fd >= 0) return source_fd;
+
+    const fd = std.posix.socket(
+        linux.AF.NETLINK,
+        linux.SOCK.DGRAM | linux.SOCK.CLOEXEC | linux.SOCK.NONBLOCK,
+        linux.NETLINK.KOBJECT_UEVENT,
+    ) catch return null;
+
+    var addr = linux.sockaddr.nl{ .pid = 0, .groups = kernel_group };
+    std.posix.bind(fd, @ptrCast(&addr), @sizeOf(linux.sockaddr.nl)) catch {
+        std.posix.close(fd);
+        return null;
+    };
+
+    source_fd = fd;
+    owns_source = true;
+    return fd;
+}
+
+pub fn set_source(fd: i32) void {
+    close();
+    const flags = std.posix.fcntl(fd, std.posix.F.GETFL, 0) catch return;
+    const nonblock: u32 = @bitCast(std.posix.O{ .NONBLOCK = true });
+    _ = std.posix.fcntl(fd, std.posix.F.SETFL, flags | nonblock) catch return;
+    source_fd = fd;
+    owns_source = false;
+}
+
+pub fn close() void {
+    if (source_fd >= 0 and owns_source) {
+        std.posix.close(source_fd);
+    }
+    source_fd = -1;
+    owns_source = false;
+}
+
+pub fn get_fd() ?i32 {
+    if (source_fd < 0) return null;
+    return source_fd;
+}
+
+pub fn is_active() bool {
+    return source_fd >= 0;
+}
+
+pub fn next_event(buffer: []u8) ?Event {
+    if (source_fd < 0) return null;
+    while (true) {
+        var sender = std.mem.zeroes(linux.sockaddr.nl);
+        var sender_len: std.posix.socklen_t = @sizeOf(linux.sockaddr.nl);
+        const len = std.posix.recvfrom(source_fd, buffer, 0, @ptrCast(&sender), &sender_len) catch return null;
+        if (len == 0) return null;
+        if (sender.family == linux.AF.NETLINK and sender.pid != 0) continue;
+        if (parse(buffer[0..len])) |event| {
+            return event;
+        }
+    }
+}
+
+pub fn parse(message: []const u8) ?Event {
+    var fields = std.mem.splitScalar(u8, message, 0);
+    const header = fields.next() orelse return null;
+    if (std.mem.indexOfScalar(u8, header, '@') == null) return null;
+
+    var event = Event{};
+    while (fields.next()) |field| {
+        const separator = std.mem.indexOfScalar(u8, field, '=') orelse continue;
+        const key = field[0..separator];
+        const value = field[separator + 1 ..];
+        if (std.mem.eql(u8, key, "ACTION")) {
+            event.action = value;
+        } else if (std.mem.eql(u8, key, "SUBSYSTEM")) {
+            event.subsystem = value;
+        } else if (std.mem.eql(u8, key, "POWER_SUPPLY_NAME")) {
+            event.supply_name = value;
+        }
+    }
+    return event;
+}
+
+pub fn is_power_supply(event: Event) bool {
+    return std.mem.eql(u8, event.subsystem, "power_supply");
+}
+
+test "power supply uevent from a synthetic source" {
+    var fds: [2]i32 = undefined;
+    try std.testing.expectEqual(linux.E.SUCCESS, linux.E.init(linux.socketpair(linux.AF.UNIX, linux.SOCK.DGRAM | linux.SOCK.CLOEXEC, 0, &fds)));
+    defer std.posix.close(fds[0]);
+    defer std.posix.close(fds[1]);
+
+    set_source(fds[0]);
+    defer close();
+
+    _ = try std.posix.write(fds[1], "change@/devices/platform/battery/power_supply/BAT0\x00ACTION=change\x00SUBSYSTEM=power_supply\x00POWER_SUPPLY_NAME=BAT0\x00");
+    _ = try std.posix.write(fds[1], "add@/devices/virtual/net/tun0\x00ACTION=add\x00SUBSYSTEM=net\x00");
+
+    var buffer: [1024]u8 = undefined;
+    const battery = next_event(&buffer) orelse return error.TestExpectedEvent;
+    try std.testing.expect(is_power_supply(battery));
+    try std.testing.expectEqualStrings("change", battery.action);
+    try std.testing.expectEqualStrings("BAT0", battery.supply_name);
+
+    const network = next_event(&buffer) orelse return error.TestExpectedEvent;
+    try std.testing.expect(!is_power_supply(network));
+
+    try std.testing.expect(next_event(&buffer) == null);
+}
+
+test "parse rejects messages without an action header" {
+    try std.testing.expect(parse("libudev\x00SUBSYSTEM=power_supply\x00") == null);
+    const event = parse("change@/devices/BAT1\x00SUBSYSTEM=power_supply\x00POWER_SUPPLY_NAME=BAT1") orelse return error.TestExpectedEvent;
+    try std.testing.expect(is_power_supply(event));
+    try std.testing.expectEqualStrings("BAT1", event.supply_name);
+}
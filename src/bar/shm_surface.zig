@@ -0,0 +1,457 @@
+const std = @import("std");
+const builtin = @import("builtin");
+const xlib = @import("../x11/xlib.zig");
+
+const c = xlib.c;
+
+const lanes = 8;
+const Pixels = @Vector(lanes, u32);
+const Coverage = @Vector(lanes, u8);
+const Shift = @Vector(lanes, u5);
+const merge_gap_chunks: usize = 4;
+const opaque_alpha: u32 = 0xff000000;
+
+const native_byte_order: c_int = if (builtin.cpu.arch.endian() == .little) c.LSBFirst else c.MSBFirst;
+
+const Glyph = struct {
+    offset: usize,
+    width: u32,
+    rows: u32,
+    left: i32,
+    top: i32,
+    advance: i32,
+};
+
+var attach_failed: bool = false;
+
+fn on_attach_error(_: ?*xlib.Display, _: [*c]xlib.XErrorEvent) callconv(.c) c_int {
+    attach_failed = true;
+    return 0;
+}
+
+fn is_local_display(display: *xlib.Display) bool {
+    const name = std.mem.span(c.XDisplayString(display));
+    return std.mem.startsWith(u8, name, ":") or std.mem.startsWith(u8, name, "unix:");
+}
+
+pub const Surface = struct {
+    allocator: std.mem.Allocator,
+    display: *xlib.Display,
+    font: *xlib.XftFont,
+    image: *c.XImage,
+    shm_info: c.XShmSegmentInfo,
+    graphics_context: xlib.GC,
+    width: i32,
+    height: i32,
+    stride: usize,
+    pixels: []u32,
+    shadow: []u32,
+    dirty_chunks: []bool,
+    full_damage: bool,
+    glyphs: std.AutoHashMapUnmanaged(u32, Glyph),
+    coverage: std.ArrayListUnmanaged(u8),
+
+    pub fn create(
+        allocator: std.mem.Allocator,
+        display: *xlib.Display,
+        screen: c_int,
+        window: xlib.Window,
+        width: i32,
+        height: i32,
+        font: *xlib.XftFont,
+    ) ?*Surface {
+        if (width <= 0 or height <= 0) return null;
+        if (!is_local_display(display)) return null;
+        if (xlib.XShmQueryExtension(display) == 0) return null;
+
+        const visual = xlib.XDefaultVisual(display, screen);
+        const depth = xlib.XDefaultDepth(display, screen);
+        if (depth != 24 and depth != 32) return null;
+        if (visual.*.red_mask != 0xff0000 or visual.*.green_mask != 0x00ff00 or visual.*.blue_mask != 0x0000ff) return null;
+
+        const surface = allocator.create(Surface) catch return null;
+        surface.shm_info = std.mem.zeroes(c.XShmSegmentInfo);
+
+        const created_image = c.XShmCreateImage(display, visual, @intCast(depth), c.ZPixmap, null, &surface.shm_info, @intCast(width), @intCast(height));
+        if (created_image == null) {
+            allocator.destroy(surface);
+            return null;
+        }
+        const image: *c.XImage = created_image;
+        if (image.*.bits_per_pixel != 32 or image.*.byte_order != native_byte_order) {
+            destroy_image(image);
+            allocator.destroy(surface);
+            return null;
+        }
+
+        const stride: usize = @intCast(@divExact(image.*.bytes_per_line, 4));
+        const rows: usize = @intCast(height);
+        const shmid = c.shmget(c.IPC_PRIVATE, stride * rows * 4, c.IPC_CREAT | 0o600);
+        if (shmid < 0) {
+            destroy_image(image);
+            allocator.destroy(surface);
+            return null;
+        }
+
+        const address = c.shmat(shmid, null, 0);
+        if (@intFromPtr(address) == std.math.maxInt(usize)) {
+            _ = c.shmctl(shmid, c.IPC_RMID, null);
+            destroy_image(image);
+            allocator.destroy(surface);
+            return null;
+        }
+
+        surface.shm_info.shmid = shmid;
+        surface.shm_info.shmaddr = @ptrCast(address);
+        surface.shm_info.readOnly = xlib.False;
+        image.*.data = surface.shm_info.shmaddr;
+
+        attach_failed = false;
+        const previous_handler = xlib.XSetErrorHandler(on_attach_error);
+        const attached = c.XShmAttach(display, &surface.shm_info);
+        _ = xlib.XSync(display, xlib.False);
+        _ = xlib.XSetErrorHandler(previous_handler);
+        _ = c.shmctl(shmid, c.IPC_RMID, null);
+
+        if (attached == 0 or attach_failed) {
+            _ = c.shmdt(address);
+            image.*.data = null;
+            destroy_image(image);
+            allocator.destroy(surface);
+            return null;
+        }
+
+        const columns: usize = @intCast(width);
+        const shadow = allocator.alloc(u32, columns * rows) catch null;
+        const dirty_chunks = allocator.alloc(bool, (columns + lanes - 1) / lanes) catch null;
+        if (shadow == null or dirty_chunks == null) {
+            if (shadow) |buffer| allocator.free(buffer);
+            if (dirty_chunks) |buffer| allocator.free(buffer);
+            _ = c.XShmDetach(display, &surface.shm_info);
+            _ = c.shmdt(address);
+            image.*.data = null;
+            destroy_image(image);
+            allocator.destroy(surface);
+            return null;
+        }
+
+        const shm_info = surface.shm_info;
+        const pixel_base: [*]u32 = @ptrCast(@alignCast(shm_info.shmaddr));
+        surface.* = .{
+            .allocator = allocator,
+            .display = display,
+            .font = font,
+            .image = image,
+            .shm_info = shm_info,
+            .graphics_context = xlib.XCreateGC(display, window, 0, null),
+            .width = width,
+            .height = height,
+            .stride = stride,
+            .pixels = pixel_base[0 .. stride * rows],
+            .shadow = shadow.?,
+            .dirty_chunks = dirty_chunks.?,
+            .full_damage = true,
+            .glyphs = .{},
+            .coverage = .{},
+        };
+        return surface;
+    }
+
+    pub fn destroy(self: *Surface) void {
+        _ = c.XShmDetach(self.display, &self.shm_info);
+        _ = c.shmdt(self.shm_info.shmaddr);
+        self.image.*.data = null;
+        destroy_image(self.image);
+        _ = xlib.XFreeGC(self.display, self.graphics_context);
+        self.glyphs.deinit(self.allocator);
+        self.coverage.deinit(self.allocator);
+        self.allocator.free(self.shadow);
+        self.allocator.free(self.dirty_chunks);
+        self.allocator.destroy(self);
+    }
+
+    pub fn memory_bytes(self: *const Surface) usize {
+        return (self.pixels.len + self.shadow.len) * @sizeOf(u32) + self.dirty_chunks.len + self.coverage.capacity + self.glyphs.capacity() * @sizeOf(Glyph);
+    }
+
+    pub fn damage_all(self: *Surface) void {
+        self.full_damage = true;
+    }
+
+    pub fn fill_rect(self: *Surface, x: i32, y: i32, width: i32, height: i32, color: c_ulong) void {
+        const x0: usize = @intCast(std.math.clamp(x, 0, self.width));
+        const x1: usize = @intCast(std.math.clamp(x + width, 0, self.width));
+        const y0: usize = @intCast(std.math.clamp(y, 0, self.height));
+        const y1: usize = @intCast(std.math.clamp(y + height, 0, self.height));
+        if (x0 >= x1) return;
+
+        const value = opaque_alpha | @as(u32, @truncate(color));
+        var row = y0;
+        while (row < y1) : (row += 1) {
+            fill_span(self.pixels[row * self.stride ..][x0..x1], value);
+        }
+    }
+
+    pub fn draw_text(self: *Surface, x: i32, y: i32, text: []const u8, color: c_ulong) void {
+        var pen = x;
+        var index: usize = 0;
+        while (index < text.len) {
+            const codepoint = next_codepoint(text, &index);
+            const glyph = self.get_glyph(codepoint) orelse continue;
+            self.blit(glyph, pen + glyph.left, y - glyph.top, @truncate(color));
+            pen += glyph.advance;
+            if (pen >= self.width) break;
+        }
+    }
+
+    pub fn text_width(self: *Surface, text: []const u8) i32 {
+        var width: i32 = 0;
+        var index: usize = 0;
+        while (index < text.len) {
+            const codepoint = next_codepoint(text, &index);
+            const glyph = self.get_glyph(codepoint) orelse continue;
+            width += glyph.advance;
+        }
+        return width;
+    }
+
+    pub fn present(self: *Surface, window: xlib.Window) void {
+        self.find_damage();
+
+        var pushed = false;
+        var chunk: usize = 0;
+        while (chunk < self.dirty_chunks.len) {
+            if (!self.dirty_chunks[chunk]) {
+                chunk += 1;
+                continue;
+            }
+
+            const start = chunk;
+            var end = chunk + 1;
+            var gap: usize = 0;
+            var scan = end;
+            while (scan < self.dirty_chunks.len and gap <= merge_gap_chunks) : (scan += 1) {
+                if (self.dirty_chunks[scan]) {
+                    end = scan + 1;
+                    gap = 0;
+                } else {
+                    gap += 1;
+                }
+            }
+            chunk = end;
+
+            const columns: usize = @intCast(self.width);
+            const x0 = start * lanes;
+            const x1 = @min(end * lanes, columns);
+            _ = c.XShmPutImage(
+                self.display,
+                window,
+                self.graphics_context,
+                self.image,
+                @intCast(x0),
+                0,
+                @intCast(x0),
+                0,
+                @intCast(x1 - x0),
+                @intCast(self.height),
+                xlib.False,
+            );
+            self.store_shadow(x0, x1);
+            pushed = true;
+        }
+
+        if (pushed) {
+            _ = xlib.XSync(self.display, xlib.False);
+        }
+        self.full_damage = false;
+    }
+
+    fn find_damage(self: *Surface) void {
+        @memset(self.dirty_chunks, self.full_damage);
+        if (self.full_damage) return;
+
+        const columns: usize = @intCast(self.width);
+        const whole_chunks = columns / lanes;
+        var row: usize = 0;
+        while (row < @as(usize, @intCast(self.height))) : (row += 1) {
+            const current = self.pixels[row * self.stride ..][0..columns];
+            const previous = self.shadow[row * columns ..][0..columns];
+
+            var chunk: usize = 0;
+            while (chunk < whole_chunks) : (chunk += 1) {
+                if (self.dirty_chunks[chunk]) continue;
+                const a: Pixels = current[chunk * lanes ..][0..lanes].*;
+                const b: Pixels = previous[chunk * lanes ..][0..lanes].*;
+                if (@reduce(.Or, a != b)) {
+                    self.dirty_chunks[chunk] = true;
+                }
+            }
+
+            if (whole_chunks < self.dirty_chunks.len and !self.dirty_chunks[whole_chunks]) {
+                const tail_start = whole_chunks * lanes;
+                if (!std.mem.eql(u32, current[tail_start..], previous[tail_start..])) {
+                    self.dirty_chunks[whole_chunks] = true;
+                }
+            }
+        }
+    }
+
+    fn store_shadow(self: *Surface, x0: usize, x1: usize) void {
+        const columns: usize = @intCast(self.width);
+        var row: usize = 0;
+        while (row < @as(usize, @intCast(self.height))) : (row += 1) {
+            @memcpy(self.shadow[row * columns ..][x0..x1], self.pixels[row * self.stride ..][x0..x1]);
+        }
+    }
+
+    fn blit(self: *Surface, glyph: Glyph, x: i32, y: i32, color: u32) void {
+        const glyph_width: i32 = @intCast(glyph.width);
+        const glyph_rows: i32 = @intCast(glyph.rows);
+
+        const clip_left = @max(0, -x);
+        const clip_right = @min(glyph_width, self.width - x);
+        if (clip_left >= clip_right) return;
+
+        var glyph_row = @max(0, -y);
+        const last_row = @min(glyph_rows, self.height - y);
+        while (glyph_row < last_row) : (glyph_row += 1) {
+            const target_row: usize = @intCast(y + glyph_row);
+            const target_x: usize = @intCast(x + clip_left);
+            const span: usize = @intCast(clip_right - clip_left);
+            const source_start = glyph.offset + @as(usize, @intCast(glyph_row)) * glyph.width + @as(usize, @intCast(clip_left));
+
+            blend_span(
+                self.pixels[target_row * self.stride + target_x ..][0..span],
+                self.coverage.items[source_start..][0..span],
+                color,
+            );
+        }
+    }
+
+    fn get_glyph(self: *Surface, codepoint: u32) ?Glyph {
+        if (self.glyphs.get(codepoint)) |glyph| return glyph;
+
+        const glyph = self.rasterize(codepoint) orelse return null;
+        self.glyphs.put(self.allocator, codepoint, glyph) catch return null;
+        return glyph;
+    }
+
+    fn rasterize(self: *Surface, codepoint: u32) ?Glyph {
+        const glyph_index = c.XftCharIndex(self.display, self.font, codepoint);
+        const face = c.XftLockFace(self.font);
+        if (face == null) return null;
+        defer c.XftUnlockFace(self.font);
+
+        if (c.FT_Load_Glyph(face, glyph_index, c.FT_LOAD_RENDER) != 0) return null;
+
+        const slot = face.*.glyph;
+        const bitmap = slot.*.bitmap;
+        const pitch: usize = @abs(bitmap.pitch);
+        const offset = self.coverage.items.len;
+        self.coverage.resize(self.allocator, offset + bitmap.width * bitmap.rows) catch return null;
+
+        var row: usize = 0;
+        while (row < bitmap.rows) : (row += 1) {
+            const source = bitmap.buffer[row * pitch ..][0..pitch];
+            const target = self.coverage.items[offset + row * bitmap.width ..][0..bitmap.width];
+            if (bitmap.pixel_mode == c.FT_PIXEL_MODE_MONO) {
+                for (target, 0..) |*value, column| {
+                    const bit = (source[column / 8] >> @intCast(7 - column % 8)) & 1;
+                    value.* = if (bit != 0) 0xff else 0;
+                }
+            } else {
+                @memcpy(target, source[0..bitmap.width]);
+            }
+        }
+
+        return .{
+            .offset = offset,
+            .width = bitmap.width,
+            .rows = bitmap.rows,
+            .left = slot.*.bitmap_left,
+            .top = slot.*.bitmap_top,
+            .advance = @intCast((slot.*.advance.x + 32) >> 6),
+        };
+    }
+};
+
+fn destroy_image(image: *c.XImage) void {
+    if (image.*.f.destroy_image) |destroy_fn| {
+        _ = destroy_fn(image);
+    }
+}
+
+fn next_codepoint(text: []const u8, index: *usize) u32 {
+    const length = std.unicode.utf8ByteSequenceLength(text[index.*]) catch {
+        index.* += 1;
+        return 0xfffd;
+    };
+    if (index.* + length > text.len) {
+        index.* = text.len;
+        return 0xfffd;
+    }
+    const codepoint = std.unicode.utf8Decode(text[index.*..][0..length]) catch 0xfffd;
+    index.* += length;
+    return codepoint;
+}
+
+fn fill_span(span: []u32, value: u32) void {
+    const splat: Pixels = @splat(value);
+    var index: usize = 0;
+    while (index + lanes <= span.len) : (index += lanes) {
+        span[index..][0..lanes].* = splat;
+    }
+    while (index < span.len) : (index += 1) {
+        span[index] = value;
+    }
+}
+
+fn channel(pixels: Pixels, comptime shift: u5) Pixels {
+    const amount: Shift = @splat(shift);
+    const mask: Pixels = @splat(0xff);
+    return (pixels >> amount) & mask;
+}
+
+fn mix(source: Pixels, target: Pixels, alpha: Pixels) Pixels {
+    const full: Pixels = @splat(255);
+    const rounding: Pixels = @splat(128);
+    const eight: Shift = @splat(8);
+    const sum = source * alpha + target * (full - alpha) + rounding;
+    return (sum + (sum >> eight)) >> eight;
+}
+
+fn blend_span(target: []u32, coverage: []const u8, color: u32) void {
+    const color_pixels: Pixels = @splat(color);
+    const red = channel(color_pixels, 16);
+    const green = channel(color_pixels, 8);
+    const blue = channel(color_pixels, 0);
+    const alpha_bits: Pixels = @splat(opaque_alpha);
+    const shift_red: Shift = @splat(16);
+    const shift_green: Shift = @splat(8);
+
+    var index: usize = 0;
+    while (index + lanes <= target.len) : (index += lanes) {
+        const coverage_bytes: Coverage = coverage[index..][0..lanes].*;
+        if (@reduce(.Max, coverage_bytes) == 0) continue;
+
+        const alpha: Pixels = @intCast(coverage_bytes);
+        const current: Pixels = target[index..][0..lanes].*;
+        const out_red = mix(red, channel(current, 16), alpha);
+        const out_green = mix(green, channel(current, 8), alpha);
+        const out_blue = mix(blue, channel(current, 0), alpha);
+        target[index..][0..lanes].* = alpha_bits | (out_red << shift_red) | (out_green << shift_green) | out_blue;
+    }
+
+    while (index < target.len) : (index += 1) {
+        const alpha: u32 = coverage[index];
+        if (alpha == 0) continue;
+        const inverse = 255 - alpha;
+        const current = target[index];
+        var out: u32 = opaque_alpha;
+        inline for (.{ 16, 8, 0 }) |shift| {
+            const sum = ((color >> shift) & 0xff) * alpha + ((current >> shift) & 0xff) * inverse + 128;
+            out |= ((sum + (sum >> 8)) >> 8) << shift;
+        }
+        target[index] = out;
+    }
+}
@@ -0,0 +1,457 @@
+const std = @import("std");
+const posix = std.posix;
+
+const c = @cImport({
+    @cInclude("X11/Xlib.h");
+    @cInclude("X11/Xutil.h");
+});
+
+const wait_timeout_ms = 2000;
+const startup_timeout_ms = 10000;
+const split_x = 960;
+const initial_width = 200;
+const initial_height = 150;
+
+const split_left = [_][]const u8{ "--setmonitor", "bench-left", "960/254x1080/286+0+0", "screen" };
+const split_right = [_][]const u8{ "--setmonitor", "bench-right", "960/254x1080/286+960+0", "none" };
+const merge_right = [_][]const u8{ "--delmonitor", "bench-right" };
+const merge_left = [_][]const u8{ "--delmonitor", "bench-left" };
+
+const Options = struct {
+    wm_path: []const u8 = "zig-out/bin/goonwm",
+    config_path: []const u8 = "resources/bench-config.goon",
+    clients: usize = 20,
+    rounds: usize = 50,
+    hotplug_rounds: usize = 10,
+    output: ?[]const u8 = null,
+};
+
+const Samples = struct {
+    values: std.ArrayListUnmanaged(u64) = .{},
+    timeouts: usize = 0,
+
+    fn add(self: *Samples, allocator: std.mem.Allocator, elapsed_ns: ?u64) !void {
+        if (elapsed_ns) |value| {
+            try self.values.append(allocator, value);
+        } else {
+            self.timeouts += 1;
+        }
+    }
+
+    fn deinit(self: *Samples, allocator: std.mem.Allocator) void {
+        self.values.deinit(allocator);
+    }
+
+    fn write_json(self: *Samples, writer: *std.Io.Writer) !void {
+        const items = self.values.items;
+        std.mem.sort(u64, items, {}, std.sort.asc(u64));
+        var sum: u64 = 0;
+        for (items) |value| sum += value;
+        const mean = if (items.len > 0) sum / items.len else 0;
+
+        try writer.print("{{\"count\":{d},\"timeouts\":{d},\"min_us\":{d:.1},\"p50_us\":{d:.1},\"p99_us\":{d:.1},\"max_us\":{d:.1},\"mean_us\":{d:.1}}}", .{
+            items.len,
+            self.timeouts,
+            to_us(if (items.len > 0) items[0] else 0),
+            to_us(percentile(items, 0.5)),
+            to_us(percentile(items, 0.99)),
+            to_us(if (items.len > 0) items[items.len - 1] else 0),
+            to_us(mean),
+        });
+    }
+};
+
+const Arrange_State = struct {
+    mapped: bool = false,
+    arranged: bool = false,
+};
+
+const Window_Area = struct {
+    x: i32,
+    y: i32,
+    width: i32,
+    height: i32,
+};
+
+const Monitor_Info = struct {
+    selected: bool,
+    window_area: Window_Area,
+};
+
+var arrange_state: Arrange_State = .{};
+var arrange_area: Window_Area = .{ .x = 0, .y = 0, .width = 0, .height = 0 };
+
+const Client = struct {
+    display: *c.Display,
+    window: c.Window,
+};
+
+const Ipc = struct {
+    fd: posix.socket_t,
+    buffer: [64 * 1024]u8 = undefined,
+    len: usize = 0,
+    consumed: usize = 0,
+
+    fn connect(path: []const u8) !Ipc {
+        const address = try std.net.Address.initUnix(path);
+        const deadline = now() + startup_timeout_ms * std.time.ns_per_ms;
+        while (true) {
+            const fd = try posix.socket(posix.AF.UNIX, posix.SOCK.STREAM | posix.SOCK.CLOEXEC, 0);
+            if (posix.connect(fd, &address.any, address.getOsSockLen())) |_| {
+                return .{ .fd = fd };
+            } else |err| {
+                posix.close(fd);
+                if (now() >= deadline) return err;
+                std.Thread.sleep(20 * std.time.ns_per_ms);
+            }
+        }
+    }
+
+    fn close(self: *Ipc) void {
+        posix.close(self.fd);
+    }
+
+    fn send(self: *Ipc, line: []const u8) !void {
+        try write_all(self.fd, line);
+        try write_all(self.fd, "\n");
+    }
+
+    fn request(self: *Ipc, line: []const u8) ![]const u8 {
+        try self.send(line);
+        return self.read_line();
+    }
+
+    fn read_line(self: *Ipc) ![]const u8 {
+        if (self.consumed > 0) {
+            std.mem.copyForwards(u8, self.buffer[0 .. self.len - self.consumed], self.buffer[self.consumed..self.len]);
+            self.len -= self.consumed;
+            self.consumed = 0;
+        }
+        while (true) {
+            if (std.mem.indexOfScalar(u8, self.buffer[0..self.len], '\n')) |newline| {
+                self.consumed = newline + 1;
+                return self.buffer[0..newline];
+            }
+            if (self.len == self.buffer.len) return error.ResponseTooLarge;
+            if (!try wait_readable(self.fd, wait_timeout_ms)) return error.Timeout;
+            const received = try posix.read(self.fd, self.buffer[self.len..]);
+            if (received == 0) return error.EndOfStream;
+            self.len += received;
+        }
+    }
+};
+
+pub fn main() !void {
+    var gpa: std.heap.GeneralPurposeAllocator(.{}) = .{};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    const options = try parse_options();
+    if (options.clients < 2) return error.NeedTwoClients;
+
+    var xvfb: std.process.Child = undefined;
+    const display_number = try start_xvfb(allocator, &xvfb);
+    defer _ = xvfb.kill() catch {};
+
+    var display_buffer: [16]u8 = undefined;
+    const display_name = try std.fmt.bufPrintZ(&display_buffer, ":{d}", .{display_number});
+
+    var runtime_buffer: [64]u8 = undefined;
+    const runtime_dir = try std.fmt.bufPrint(&runtime_buffer, "/tmp/goonwm-e2e-{d}", .{std.os.linux.getpid()});
+    try std.fs.cwd().makePath(runtime_dir);
+    defer std.fs.cwd().deleteTree(runtime_dir) catch {};
+
+    var env_map = try std.process.getEnvMap(allocator);
+    defer env_map.deinit();
+    try env_map.put("DISPLAY", display_name);
+    try env_map.put("XDG_RUNTIME_DIR", runtime_dir);
+
+    var wm = std.process.Child.init(&.{ options.wm_path, "-c", options.config_path }, allocator);
+    wm.env_map = &env_map;
+    wm.stdin_behavior = .Ignore;
+    wm.stdout_behavior = .Ignore;
+    wm.stderr_behavior = .Ignore;
+    try wm.spawn();
+    defer _ = wm.kill() catch {};
+
+    var socket_buffer: [std.fs.max_path_bytes]u8 = undefined;
+    const socket_path = try std.fmt.bufPrint(&socket_buffer, "{s}/goonwm-{d}.sock", .{ runtime_dir, display_number });
+    var ipc = try Ipc.connect(socket_path);
+    defer ipc.close();
+    _ = try ipc.request("query layout");
+    arrange_area = try selected_window_area(allocator, try ipc.request("query monitors"));
+
+    const clients = try allocator.alloc(Client, options.clients);
+    defer allocator.free(clients);
+    var opened: usize = 0;
+    defer for (clients[0..opened]) |client| {
+        _ = c.XCloseDisplay(client.display);
+    };
+    for (clients, 0..) |*client, index| {
+        client.* = try open_client(display_name, index);
+        opened += 1;
+    }
+    const pollfds = try allocator.alloc(posix.pollfd, clients.len);
+    defer allocator.free(pollfds);
+
+    var map_samples: Samples = .{};
+    defer map_samples.deinit(allocator);
+    for (clients, 0..) |*client, index| {
+        arrange_state = .{};
+        const start = now();
+        _ = c.XMapWindow(client.display, client.window);
+        _ = c.XFlush(client.display);
+        try map_samples.add(allocator, wait_any(clients[index .. index + 1], pollfds[0..1], start, is_arranged));
+    }
+
+    var tag_samples: Samples = .{};
+    defer tag_samples.deinit(allocator);
+    const watched = clients[clients.len - 1 ..];
+    for (0..options.rounds) |_| {
+        drain(clients);
+        var start = now();
+        try ipc.send("action view-tag 1");
+        try tag_samples.add(allocator, wait_any(watched, pollfds[0..1], start, is_hidden));
+        _ = try ipc.read_line();
+
+        drain(clients);
+        start = now();
+        try ipc.send("action view-tag 0");
+        try tag_samples.add(allocator, wait_any(watched, pollfds[0..1], start, is_shown));
+        _ = try ipc.read_line();
+    }
+
+    var focus_samples: Samples = .{};
+    defer focus_samples.deinit(allocator);
+    for (0..options.rounds) |_| {
+        drain(clients);
+        const start = now();
+        try ipc.send("action focus-next");
+        try focus_samples.add(allocator, wait_any(clients, pollfds, start, is_focused));
+        _ = try ipc.read_line();
+    }
+
+    var hotplug_samples: Samples = .{};
+    defer hotplug_samples.deinit(allocator);
+    for (0..options.hotplug_rounds) |_| {
+        drain(clients);
+        var start = now();
+        run_xrandr(allocator, display_name, &split_left) catch |err| {
+            std.debug.print("bench-e2e: skipping hotplug scenario, xrandr failed: {}\n", .{err});
+            break;
+        };
+        try run_xrandr(allocator, display_name, &split_right);
+        try hotplug_samples.add(allocator, wait_any(watched, pollfds[0..1], start, fits_left));
+
+        drain(clients);
+        start = now();
+        try run_xrandr(allocator, display_name, &merge_right);
+        try run_xrandr(allocator, display_name, &merge_left);
+        try hotplug_samples.add(allocator, wait_any(watched, pollfds[0..1], start, spans_split));
+    }
+
+    const bar_json = try allocator.dupe(u8, try ipc.request("query bar"));
+    defer allocator.free(bar_json);
+
+    var output_buffer: [4096]u8 = undefined;
+    var output_file = if (options.output) |path| try std.fs.cwd().createFile(path, .{}) else std.fs.File.stdout();
+    defer if (options.output != null) output_file.close();
+    var output_writer = output_file.writer(&output_buffer);
+    const out = &output_writer.interface;
+
+    try out.print("{{\"clients\":{d},\"rounds\":{d},\"map_to_arranged\":", .{ options.clients, options.rounds });
+    try map_samples.write_json(out);
+    try out.writeAll(",\"tag_switch\":");
+    try tag_samples.write_json(out);
+    try out.writeAll(",\"focus_change\":");
+    try focus_samples.write_json(out);
+    try out.writeAll(",\"monitor_hotplug\":");
+    try hotplug_samples.write_json(out);
+    try out.print(",\"bar\":{s}}}\n", .{bar_json});
+    try out.flush();
+}
+
+fn parse_options() !Options {
+    var options = Options{};
+    var args = std.process.args();
+    _ = args.skip();
+    while (args.next()) |arg| {
+        if (std.mem.eql(u8, arg, "--wm")) {
+            options.wm_path = args.next() orelse return error.MissingArgument;
+        } else if (std.mem.eql(u8, arg, "--config")) {
+            options.config_path = args.next() orelse return error.MissingArgument;
+        } else if (std.mem.eql(u8, arg, "--clients")) {
+            options.clients = try std.fmt.parseInt(usize, args.next() orelse return error.MissingArgument, 10);
+        } else if (std.mem.eql(u8, arg, "--rounds")) {
+            options.rounds = try std.fmt.parseInt(usize, args.next() orelse return error.MissingArgument, 10);
+        } else if (std.mem.eql(u8, arg, "--hotplug-rounds")) {
+            options.hotplug_rounds = try std.fmt.parseInt(usize, args.next() orelse return error.MissingArgument, 10);
+        } else if (std.mem.eql(u8, arg, "--output")) {
+            options.output = args.next() orelse return error.MissingArgument;
+        } else {
+            std.debug.print("usage: bench-e2e [--wm goonwm] [--config file] [--clients n] [--rounds n] [--hotplug-rounds n] [--output file]\n", .{});
+            return error.InvalidArgument;
+        }
+    }
+    return options;
+}
+
+fn start_xvfb(allocator: std.mem.Allocator, child: *std.process.Child) !u32 {
+    const pipe = try posix.pipe();
+    defer posix.close(pipe[0]);
+
+    var fd_buffer: [16]u8 = undefined;
+    const fd_text = try std.fmt.bufPrint(&fd_buffer, "{d}", .{pipe[1]});
+    child.* = std.process.Child.init(&.{ "Xvfb", "-displayfd", fd_text, "-screen", "0", "1920x1080x24", "-nolisten", "tcp", "-noreset" }, allocator);
+    child.stdin_behavior = .Ignore;
+    child.stdout_behavior = .Ignore;
+    child.stderr_behavior = .Ignore;
+    child.spawn() catch |err| {
+        posix.close(pipe[1]);
+        return err;
+    };
+    posix.close(pipe[1]);
+
+    var buffer: [16]u8 = undefined;
+    var len: usize = 0;
+    while (std.mem.indexOfScalar(u8, buffer[0..len], '\n') == null) {
+        if (len == buffer.len or !try wait_readable(pipe[0], startup_timeout_ms)) return error.XvfbDidNotStart;
+        const received = try posix.read(pipe[0], buffer[len..]);
+        if (received == 0) return error.XvfbDidNotStart;
+        len += received;
+    }
+    return std.fmt.parseInt(u32, std.mem.trim(u8, buffer[0..len], " \n"), 10);
+}
+
+fn run_xrandr(allocator: std.mem.Allocator, display_name: []const u8, args: []const []const u8) !void {
+    var argv: [8][]const u8 = undefined;
+    argv[0] = "xrandr";
+    argv[1] = "--display";
+    argv[2] = display_name;
+    @memcpy(argv[3..][0..args.len], args);
+
+    var child = std.process.Child.init(argv[0 .. 3 + args.len], allocator);
+    child.stdin_behavior = .Ignore;
+    child.stdout_behavior = .Ignore;
+    child.stderr_behavior = .Ignore;
+    switch (try child.spawnAndWait()) {
+        .Exited => |code| if (code != 0) return error.XrandrFailed,
+        else => return error.XrandrFailed,
+    }
+}
+
+fn open_client(display_name: [:0]const u8, index: usize) !Client {
+    const display = c.XOpenDisplay(display_name) orelse return error.CannotOpenDisplay;
+    const window = c.XCreateSimpleWindow(display, c.XDefaultRootWindow(display), 0, 0, initial_width, initial_height, 0, 0, 0xffffff);
+    _ = c.XSelectInput(display, window, c.StructureNotifyMask | c.FocusChangeMask);
+
+    var name_buffer: [32]u8 = undefined;
+    const name = try std.fmt.bufPrintZ(&name_buffer, "bench client {d}", .{index});
+    _ = c.XStoreName(display, window, name);
+    _ = c.XSync(display, c.False);
+    return .{ .display = display, .window = window };
+}
+
+fn drain(clients: []Client) void {
+    for (clients) |client| {
+        _ = c.XSync(client.display, c.False);
+        while (c.XPending(client.display) > 0) {
+            var event: c.XEvent = undefined;
+            _ = c.XNextEvent(client.display, &event);
+        }
+    }
+}
+
+fn wait_any(clients: []Client, pollfds: []posix.pollfd, start_ns: u64, predicate: *const fn (*const c.XEvent) bool) ?u64 {
+    const deadline = start_ns + wait_timeout_ms * std.time.ns_per_ms;
+    while (true) {
+        for (clients, pollfds) |client, *pollfd| {
+            while (c.XPending(client.display) > 0) {
+                var event: c.XEvent = undefined;
+                _ = c.XNextEvent(client.display, &event);
+                if (predicate(&event)) return now() - start_ns;
+            }
+            pollfd.* = .{ .fd = c.XConnectionNumber(client.display), .events = posix.POLL.IN, .revents = 0 };
+        }
+        const current = now();
+        if (current >= deadline) return null;
+        _ = posix.poll(pollfds, @intCast((deadline - current) / std.time.ns_per_ms + 1)) catch return null;
+    }
+}
+
+fn selected_window_area(allocator: std.mem.Allocator, json: []const u8) !Window_Area {
+    const parsed = try std.json.parseFromSlice([]Monitor_Info, allocator, json, .{ .ignore_unknown_fields = true });
+    defer parsed.deinit();
+    for (parsed.value) |monitor| {
+        if (monitor.selected) return monitor.window_area;
+    }
+    return error.NoSelectedMonitor;
+}
+
+fn is_arranged(event: *const c.XEvent) bool {
+    if (event.type == c.MapNotify) {
+        arrange_state.mapped = true;
+    } else if (event.type == c.ConfigureNotify and event.xconfigure.send_event == 0) {
+        const configure = event.xconfigure;
+        const moved = configure.x != 0 or configure.y != 0 or configure.width != initial_width or configure.height != initial_height;
+        if (moved and inside_arrange_area(configure)) {
+            arrange_state.arranged = true;
+        }
+    }
+    return arrange_state.mapped and arrange_state.arranged;
+}
+
+fn inside_arrange_area(configure: c.XConfigureEvent) bool {
+    const border = 2 * configure.border_width;
+    return configure.x >= arrange_area.x and
+        configure.y >= arrange_area.y and
+        configure.x + configure.width + border <= arrange_area.x + arrange_area.width and
+        configure.y + configure.height + border <= arrange_area.y + arrange_area.height;
+}
+
+fn is_hidden(event: *const c.XEvent) bool {
+    return event.type == c.ConfigureNotify and event.xconfigure.x < 0;
+}
+
+fn is_shown(event: *const c.XEvent) bool {
+    return event.type == c.ConfigureNotify and event.xconfigure.x >= 0;
+}
+
+fn fits_left(event: *const c.XEvent) bool {
+    return event.type == c.ConfigureNotify and event.xconfigure.x >= 0 and event.xconfigure.x + event.xconfigure.width <= split_x;
+}
+
+fn spans_split(event: *const c.XEvent) bool {
+    return event.type == c.ConfigureNotify and event.xconfigure.x + event.xconfigure.width > split_x;
+}
+
+fn is_focused(event: *const c.XEvent) bool {
+    return event.type == c.FocusIn and event.xfocus.mode == c.NotifyNormal and event.xfocus.detail != c.NotifyPointer;
+}
+
+fn wait_readable(fd: posix.fd_t, timeout_ms: i32) !bool {
+    var fds = [_]posix.pollfd{.{ .fd = fd, .events = posix.POLL.IN, .revents = 0 }};
+    return try posix.poll(&fds, timeout_ms) > 0;
+}
+
+fn write_all(fd: posix.socket_t, bytes: []const u8) !void {
+    var sent: usize = 0;
+    while (sent < bytes.len) {
+        sent += try posix.send(fd, bytes[sent..], posix.MSG.NOSIGNAL);
+    }
+}
+
+fn now() u64 {
+    const ts = posix.clock_gettime(.MONOTONIC) catch return 0;
+    return @as(u64, @intCast(ts.sec)) * std.time.ns_per_s + @as(u64, @intCast(ts.nsec));
+}
+
+fn percentile(sorted: []const u64, fraction: f64) u64 {
+    if (sorted.len == 0) return 0;
+    const rank: usize = @intFromFloat(@ceil(fraction * @as(f64, @floatFromInt(sorted.len))));
+    return sorted[@min(@max(rank, 1), sorted.len) - 1];
+}
+
+fn to_us(ns: u64) f64 {
+    return @as(f64, @floatFromInt(ns)) / std.time.ns_per_us;
+}
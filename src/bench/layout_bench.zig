@@ -0,0 +1,231 @@
+const std = @import("std");
+const geometry = @import("geometry");
+
+const Area = geometry.Area;
+const Placement = geometry.Placement;
+const Rect = geometry.Rect;
+const Tiled = geometry.Tiled;
+
+const Layout = struct {
+    name: []const u8,
+    arrange: *const fn (Area, []const Tiled, []Placement) void,
+    disjoint: bool,
+    saturated: ?*const fn (Area, []const Tiled) bool,
+};
+
+const layouts = [_]Layout{
+    .{ .name = "tile", .arrange = &geometry.tile, .disjoint = true, .saturated = &tile_saturated },
+    .{ .name = "monocle", .arrange = &geometry.monocle, .disjoint = false, .saturated = null },
+    .{ .name = "scroll", .arrange = &geometry.scroll, .disjoint = true, .saturated = null },
+};
+
+const Setting = struct {
+    nmaster: i32,
+    mfact: f32,
+    gap: i32,
+    size_hints: bool,
+};
+
+const settings = [_]Setting{
+    .{ .nmaster = 1, .mfact = 0.55, .gap = 0, .size_hints = false },
+    .{ .nmaster = 1, .mfact = 0.55, .gap = 5, .size_hints = true },
+    .{ .nmaster = 2, .mfact = 0.7, .gap = 10, .size_hints = false },
+    .{ .nmaster = 0, .mfact = 0.5, .gap = 5, .size_hints = true },
+    .{ .nmaster = 3, .mfact = 0.3, .gap = 20, .size_hints = true },
+};
+
+const frame_variants = [_]Tiled{
+    .{},
+    .{ .border_width = 1 },
+    .{ .border_width = 2, .hints = .{ .base_width = 40, .base_height = 30, .min_width = 40, .min_height = 30 } },
+    .{ .border_width = 3, .hints = .{
+        .base_width = 4,
+        .base_height = 4,
+        .increment_width = 7,
+        .increment_height = 13,
+        .min_width = 20,
+        .min_height = 16,
+        .max_width = 900,
+        .max_height = 700,
+    } },
+    .{ .border_width = 1, .hints = .{ .max_width = 320, .max_height = 240 } },
+};
+
+const monitors = [_]Rect{
+    .{ .x = 0, .y = 24, .width = 1920, .height = 1056 },
+    .{ .x = 1920, .y = 0, .width = 2560, .height = 1440 },
+};
+
+const client_counts = [_]usize{ 1, 2, 5, 10, 100, 1000, 10000 };
+const target_ns: u64 = 20 * std.time.ns_per_ms;
+
+const Report = struct {
+    overlaps: usize = 0,
+    out_of_bounds: usize = 0,
+    spill: usize = 0,
+    degenerate: usize = 0,
+};
+
+pub fn main() !void {
+    var gpa: std.heap.GeneralPurposeAllocator(.{}) = .{};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    var stdout_buffer: [4096]u8 = undefined;
+    var stdout_writer = std.fs.File.stdout().writer(&stdout_buffer);
+    const out = &stdout_writer.interface;
+
+    const plan = try allocator.alloc(Placement, client_counts[client_counts.len - 1]);
+    defer allocator.free(plan);
+    const tiled = try allocator.alloc(Tiled, plan.len);
+    defer allocator.free(tiled);
+    for (tiled, 0..) |*frame, index| {
+        frame.* = frame_variants[index % frame_variants.len];
+        frame.window = 0x600000 + @as(c_ulong, @intCast(index));
+    }
+    const order = try allocator.alloc(usize, plan.len);
+    defer allocator.free(order);
+
+    var failures: usize = 0;
+
+    try out.print("{s:<8} {s:>9} {s:>6} {s:>7} {s:>4} {s:>6} {s:>12} {s:>8} {s:>8} {s:>8} {s:>8}\n", .{ "layout", "monitor", "count", "nmaster", "mfact", "gap", "ns/arrange", "overlap", "bounds", "spill", "empty" });
+
+    for (layouts) |layout| {
+        for (monitors) |monitor| {
+            for (settings) |setting| {
+                for (client_counts) |count| {
+                    const area = Area{
+                        .x = monitor.x,
+                        .y = monitor.y,
+                        .width = monitor.width,
+                        .height = monitor.height,
+                        .gap_outer_h = setting.gap,
+                        .gap_outer_v = setting.gap,
+                        .gap_inner_h = setting.gap,
+                        .gap_inner_v = setting.gap,
+                        .nmaster = setting.nmaster,
+                        .mfact = setting.mfact,
+                        .size_hints = setting.size_hints,
+                    };
+                    const slice = plan[0..count];
+
+                    const ns = measure(layout, area, tiled[0..count], slice);
+                    layout.arrange(area, tiled[0..count], slice);
+                    const report = check(layout, area, slice, order[0..count]);
+
+                    const saturated = if (layout.saturated) |saturated_fn| saturated_fn(area, tiled[0..count]) else false;
+                    if (report.overlaps != 0 or report.out_of_bounds != 0 or (!saturated and report.spill != 0)) {
+                        failures += 1;
+                    }
+
+                    try out.print("{s:<8} {d:>4}x{d:<4} {d:>6} {d:>7} {d:>4.2} {d:>6} {d:>12} {d:>8} {d:>8} {d:>8} {d:>8}\n", .{
+                        layout.name,
+                        monitor.width,
+                        monitor.height,
+                        count,
+                        setting.nmaster,
+                        setting.mfact,
+                        setting.gap,
+                        ns,
+                        report.overlaps,
+                        report.out_of_bounds,
+                        report.spill,
+                        report.degenerate,
+                    });
+                }
+            }
+        }
+    }
+
+    try out.print("\n{d} scenarios violated layout invariants\n", .{failures});
+    try out.flush();
+
+    if (failures != 0) {
+        std.process.exit(1);
+    }
+}
+
+fn measure(layout: Layout, area: Area, tiled: []const Tiled, plan: []Placement) u64 {
+    var timer = std.time.Timer.start() catch return 0;
+    var iterations: u64 = 0;
+    var elapsed: u64 = 0;
+    while (elapsed < target_ns) {
+        var batch: usize = 0;
+        while (batch < 16) : (batch += 1) {
+            layout.arrange(area, tiled, plan);
+            std.mem.doNotOptimizeAway(plan.ptr);
+        }
+        iterations += 16;
+        elapsed = timer.read();
+    }
+    return elapsed / iterations;
+}
+
+fn check(layout: Layout, area: Area, plan: []const Placement, order: []usize) Report {
+    var report = Report{};
+    const bounds = area.bounds();
+
+    var visible: usize = 0;
+    for (plan, 0..) |placement, index| {
+        if (!placement.visible) continue;
+        if (placement.rect.is_empty()) {
+            report.degenerate += 1;
+            continue;
+        }
+        if (!bounds.contains(placement.rect)) {
+            if (spills_below(bounds, placement.rect)) {
+                report.spill += 1;
+            } else {
+                report.out_of_bounds += 1;
+            }
+        }
+        order[visible] = index;
+        visible += 1;
+    }
+
+    if (!layout.disjoint) return report;
+
+    const candidates = order[0..visible];
+    std.mem.sort(usize, candidates, plan, less_by_top);
+
+    for (candidates, 0..) |index, position| {
+        const rect = plan[index].rect;
+        for (candidates[position + 1 ..]) |other_index| {
+            const other = plan[other_index].rect;
+            if (other.y >= rect.bottom()) break;
+            if (rect.overlaps(other)) {
+                report.overlaps += 1;
+            }
+        }
+    }
+    return report;
+}
+
+fn less_by_top(plan: []const Placement, a: usize, b: usize) bool {
+    return plan[a].rect.y < plan[b].rect.y;
+}
+
+fn spills_below(bounds: Rect, rect: Rect) bool {
+    return rect.x >= bounds.x and rect.right() <= bounds.right() and rect.y >= bounds.y and rect.bottom() > bounds.bottom();
+}
+
+fn tile_saturated(area: Area, tiled: []const Tiled) bool {
+    const master_count = @min(tiled.len, @as(usize, @intCast(@max(0, area.nmaster))));
+    return column_saturated(area, tiled[0..master_count]) or column_saturated(area, tiled[master_count..]);
+}
+
+fn column_saturated(area: Area, column: []const Tiled) bool {
+    if (column.len == 0) return false;
+    const count: i32 = @intCast(column.len);
+    const available = area.height - 2 * area.gap_outer_h - area.gap_inner_h * (count - 1);
+    var tallest: i32 = 0;
+    for (column) |frame| {
+        tallest = @max(tallest, minimum_height(area, frame));
+    }
+    return tallest > @divTrunc(available, count);
+}
+
+fn minimum_height(area: Area, frame: Tiled) i32 {
+    const hinted = if (area.size_hints) frame.hints.min_height else 0;
+    return 2 * frame.border_width + @max(1, @max(area.min_size, hinted));
+}
@@ -0,0 +1,144 @@
+const std = @import("std");
+const event_trace = @import("event_trace");
+
+const xlib = event_trace.xlib;
+
+const root_window: xlib.Window = 0x100;
+const first_window: xlib.Window = 0x600000;
+const keycode_1: c_uint = 10;
+const keycode_j: c_uint = 44;
+const event_gap_ns = 50 * std.time.ns_per_us;
+const frame_ns = 16 * std.time.ns_per_ms;
+
+const Scenario = struct {
+    name: []const u8,
+    generate: *const fn (std.Random) anyerror!void,
+};
+
+const scenarios = [_]Scenario{
+    .{ .name = "session_start", .generate = session_start },
+    .{ .name = "tag_storm", .generate = tag_storm },
+    .{ .name = "title_spam", .generate = title_spam },
+};
+
+var clock_ns: u64 = 0;
+
+pub fn main() !void {
+    var args = std.process.args();
+    _ = args.skip();
+    const dir_path = args.next() orelse {
+        std.debug.print("usage: replay-traces <output dir>\n", .{});
+        std.process.exit(2);
+    };
+    try std.fs.cwd().makePath(dir_path);
+
+    for (scenarios) |scenario| {
+        var path_buffer: [std.fs.max_path_bytes]u8 = undefined;
+        const path = try std.fmt.bufPrint(&path_buffer, "{s}/{s}.trace", .{ dir_path, scenario.name });
+
+        var prng = std.Random.DefaultPrng.init(0x600d);
+        clock_ns = 0;
+        try event_trace.start(path);
+        defer event_trace.finish();
+        try scenario.generate(prng.random());
+    }
+}
+
+fn session_start(_: std.Random) !void {
+    for (0..100) |index| {
+        try emit(map_request(window_at(index)));
+        try end_batch();
+    }
+}
+
+fn tag_storm(random: std.Random) !void {
+    for (0..9) |tag| {
+        try emit(key_press(keycode_1 + @as(c_uint, @intCast(tag))));
+        try end_batch();
+        for (0..4) |index| {
+            try emit(map_request(window_at(tag * 4 + index)));
+            try end_batch();
+        }
+    }
+
+    for (0..2000) |step| {
+        try emit(key_press(keycode_1 + random.uintLessThan(c_uint, 9)));
+        if (step % 10 == 0) {
+            try emit(key_press(keycode_j));
+        }
+        try end_batch();
+    }
+}
+
+fn title_spam(random: std.Random) !void {
+    const window_count = 20;
+    for (0..window_count) |index| {
+        try emit(map_request(window_at(index)));
+        try end_batch();
+    }
+
+    for (0..10000) |step| {
+        const window = window_at(random.uintLessThan(usize, window_count));
+        if (step % 500 == 0) {
+            try emit(enter_notify(window));
+        }
+        try emit(property_notify(window, xlib.XA_WM_NAME));
+        if (step % 25 == 24) {
+            try end_batch();
+        }
+    }
+    try end_batch();
+}
+
+fn window_at(index: usize) xlib.Window {
+    return first_window + @as(xlib.Window, @intCast(index)) * 0x200000;
+}
+
+fn emit(event: xlib.XEvent) !void {
+    clock_ns += event_gap_ns;
+    try event_trace.record(&event, clock_ns);
+}
+
+fn end_batch() !void {
+    try event_trace.end_batch(clock_ns);
+    clock_ns += frame_ns;
+}
+
+fn map_request(window: xlib.Window) xlib.XEvent {
+    var event = std.mem.zeroes(xlib.XEvent);
+    event.xmaprequest.type = xlib.MapRequest;
+    event.xmaprequest.parent = root_window;
+    event.xmaprequest.window = window;
+    return event;
+}
+
+fn key_press(keycode: c_uint) xlib.XEvent {
+    var event = std.mem.zeroes(xlib.XEvent);
+    event.xkey.type = xlib.KeyPress;
+    event.xkey.window = root_window;
+    event.xkey.root = root_window;
+    event.xkey.state = xlib.Mod4Mask;
+    event.xkey.keycode = keycode;
+    event.xkey.same_screen = xlib.True;
+    return event;
+}
+
+fn enter_notify(window: xlib.Window) xlib.XEvent {
+    var event = std.mem.zeroes(xlib.XEvent);
+    event.xcrossing.type = xlib.EnterNotify;
+    event.xcrossing.window = window;
+    event.xcrossing.root = root_window;
+    event.xcrossing.mode = xlib.NotifyNormal;
+    event.xcrossing.detail = xlib.c.NotifyNonlinear;
+    event.xcrossing.same_screen = xlib.True;
+    return event;
+}
+
+fn property_notify(window: xlib.Window, atom: xlib.Atom) xlib.XEvent {
+    var event = std.mem.zeroes(xlib.XEvent);
+    event.xproperty.type = xlib.PropertyNotify;
+    event.xproperty.window = window;
+    event.xproperty.atom = atom;
+    event.xproperty.state = xlib.c.PropertyNewValue;
+    return event;
+}
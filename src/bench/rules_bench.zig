@@ -0,0 +1,116 @@
+const std = @import("std");
+const rules = @import("rules");
+
+const Rule = rules.Rule;
+
+const Window = struct {
+    class: []const u8,
+    instance: []const u8,
+    title: []const u8,
+};
+
+const rule_counts = [_]usize{ 10, 150, 1000, 5000 };
+const window_count = 10000;
+const inventory_size = 2000;
+const monitor_count = 2;
+
+pub fn main() !void {
+    var gpa: std.heap.GeneralPurposeAllocator(.{}) = .{};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    var arena_state = std.heap.ArenaAllocator.init(allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    var stdout_buffer: [4096]u8 = undefined;
+    var stdout_writer = std.fs.File.stdout().writer(&stdout_buffer);
+    const out = &stdout_writer.interface;
+
+    var prng = std.Random.DefaultPrng.init(0x600d);
+    const random = prng.random();
+
+    const windows = try arena.alloc(Window, window_count);
+    for (windows) |*window| {
+        const app = random.uintLessThan(usize, inventory_size + inventory_size / 4);
+        window.* = .{
+            .class = try std.fmt.allocPrint(arena, "App{d}", .{app}),
+            .instance = try std.fmt.allocPrint(arena, "app{d}", .{app}),
+            .title = try std.fmt.allocPrint(arena, "Document {d} - App{d}", .{ random.uintLessThan(usize, 100), app }),
+        };
+    }
+
+    var mismatches: usize = 0;
+
+    try out.print("{s:>6} {s:>8} {s:>14} {s:>14} {s:>10} {s:>10}\n", .{ "rules", "windows", "linear ns/win", "index ns/win", "build us", "mismatch" });
+
+    for (rule_counts) |rule_count| {
+        const rule_set = try generate_rules(arena, random, rule_count);
+
+        var build_timer = try std.time.Timer.start();
+        var matcher = try rules.Matcher.init(allocator, rule_set);
+        defer matcher.deinit();
+        const build_ns = build_timer.read();
+
+        const expected = try allocator.alloc(rules.Outcome, windows.len);
+        defer allocator.free(expected);
+
+        var timer = try std.time.Timer.start();
+        for (windows, expected) |window, *outcome| {
+            outcome.* = rules.match_linear(rule_set, window.class, window.instance, window.title, monitor_count);
+        }
+        const linear_ns = timer.read();
+
+        var scenario_mismatches: usize = 0;
+        timer.reset();
+        for (windows, expected) |window, outcome| {
+            const actual = matcher.match(window.class, window.instance, window.title, monitor_count);
+            if (!std.meta.eql(actual, outcome)) scenario_mismatches += 1;
+        }
+        const index_ns = timer.read();
+        mismatches += scenario_mismatches;
+
+        try out.print("{d:>6} {d:>8} {d:>14} {d:>14} {d:>10} {d:>10}\n", .{
+            rule_count,
+            windows.len,
+            linear_ns / windows.len,
+            index_ns / windows.len,
+            build_ns / std.time.ns_per_us,
+            scenario_mismatches,
+        });
+    }
+
+    try out.print("\n{d} windows matched differently from the linear scan\n", .{mismatches});
+    try out.flush();
+
+    if (mismatches != 0) {
+        std.process.exit(1);
+    }
+}
+
+fn generate_rules(arena: std.mem.Allocator, random: std.Random, count: usize) ![]Rule {
+    const rule_set = try arena.alloc(Rule, count);
+    for (rule_set) |*rule| {
+        const app = random.uintLessThan(usize, inventory_size);
+        rule.* = .{
+            .class = null,
+            .instance = null,
+            .title = null,
+            .tags = @as(u32, 1) << random.uintLessThan(u5, 9),
+            .is_floating = random.boolean(),
+            .monitor = if (random.uintLessThan(u8, 8) == 0) @as(i32, random.uintLessThan(u8, monitor_count + 1)) else -1,
+        };
+        switch (random.uintLessThan(u8, 20)) {
+            0...13 => rule.class = try std.fmt.allocPrint(arena, "App{d}", .{app}),
+            14...15 => rule.class = try std.fmt.allocPrint(arena, "pp{d}", .{app % 100}),
+            16 => rule.instance = try std.fmt.allocPrint(arena, "app{d}", .{app}),
+            17 => {
+                rule.class = try std.fmt.allocPrint(arena, "App{d}", .{app});
+                rule.title = try std.fmt.allocPrint(arena, "Document {d}", .{random.uintLessThan(usize, 100)});
+            },
+            18 => rule.title = "Document 7",
+            else => {},
+        }
+    }
+    return rule_set;
+}
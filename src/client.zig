@@ -1,9 +1,19 @@
 const std = @import("std");
 const xlib = @import("x11/xlib.zig");
-const Monitor = @import("monitor.zig").Monitor;
+const monitor_mod = @import("monitor.zig");
+const slab = @import("slab.zig");
+const memory = @import("memory.zig");
+const geometry = @import("layouts/geometry.zig");
+const Monitor = monitor_mod.Monitor;
+
+pub const Visibility = enum { unknown, shown, moved, unmapped };
 
 pub const Client = struct {
-    name: [256]u8 = std.mem.zeroes([256]u8),
+    title: []u8 = &.{},
+    title_len: u16 = 0,
+    class_text: []u8 = &.{},
+    instance_len: u32 = 0,
+    dirty: u8 = 0,
     min_aspect: f32 = 0,
     max_aspect: f32 = 0,
     x: i32 = 0,
@@ -22,13 +32,15 @@ pub const Client = struct {
     max_height: i32 = 0,
     min_width: i32 = 0,
     min_height: i32 = 0,
-    hints_valid: bool = false,
     border_width: i32 = 0,
     old_border_width: i32 = 0,
     tags: u32 = 0,
     is_fixed: bool = false,
     is_floating: bool = false,
     is_urgent: bool = false,
+    is_attached: bool = false,
+    visibility: Visibility = .unknown,
+    ignore_unmap: u8 = 0,
     never_focus: bool = false,
     old_state: bool = false,
     is_fullscreen: bool = false,
@@ -39,34 +51,98 @@ pub const Client = struct {
 };
 
 var allocator: std.mem.Allocator = undefined;
+var clients: slab.Slab(Client, 32) = .{};
+var titles: slab.Text_Pool = .{};
 
 pub fn init(alloc: std.mem.Allocator) void {
     allocator = alloc;
 }
 
+pub fn deinit() void {
+    clients.deinit(allocator);
+    titles.deinit(allocator);
+}
+
 pub fn create(window: xlib.Window) ?*Client {
-    const client = allocator.create(Client) catch return null;
+    const client = clients.create(allocator) catch return null;
     client.* = Client{ .window = window };
     return client;
 }
 
 pub fn destroy(client: *Client) void {
-    allocator.destroy(client);
+    titles.release(client.title);
+    allocator.free(client.class_text);
+    clients.destroy(client);
+}
+
+pub fn set_title(client: *Client, text: []const u8) void {
+    const len = @min(text.len, slab.Text_Pool.max_len);
+    if (client.title.len < len or (client.title.len > 16 and len * 2 <= client.title.len)) {
+        titles.release(client.title);
+        client.title = titles.acquire(allocator, len) orelse &.{};
+    }
+    const stored = @min(len, client.title.len);
+    @memcpy(client.title[0..stored], text[0..stored]);
+    client.title_len = @intCast(stored);
+}
+
+pub fn get_title(client: *const Client) []const u8 {
+    return client.title[0..client.title_len];
+}
+
+pub fn set_class(client: *Client, instance: []const u8, class: []const u8) void {
+    const len = instance.len + class.len;
+    if (client.class_text.len != len) {
+        allocator.free(client.class_text);
+        client.class_text = allocator.alloc(u8, len) catch {
+            client.class_text = &.{};
+            client.instance_len = 0;
+            return;
+        };
+    }
+    @memcpy(client.class_text[0..instance.len], instance);
+    @memcpy(client.class_text[instance.len..], class);
+    client.instance_len = @intCast(instance.len);
+}
+
+pub fn get_class(client: *const Client) []const u8 {
+    return client.class_text[client.instance_len..];
+}
+
+pub fn get_instance(client: *const Client) []const u8 {
+    return client.class_text[0..client.instance_len];
+}
+
+pub fn fill_memory_report(report: *memory.Report) void {
+    report.clients = .{ .live = clients.live, .peak = clients.peak, .capacity = clients.capacity(), .bytes = clients.bytes() };
+    report.title_chunks = titles.chunks_in_use();
+    report.title_used_bytes = titles.used_bytes();
+    report.title_pool_bytes = titles.bytes();
 }
 
 pub fn attach(client: *Client) void {
     if (client.monitor) |monitor| {
+        monitor_mod.invalidate_tiled(monitor);
         client.next = monitor.clients;
         monitor.clients = client;
+        mark_attached(client, monitor);
     }
 }
 
+fn mark_attached(client: *Client, monitor: *Monitor) void {
+    monitor_mod.count_client(monitor, client.tags, client.is_urgent);
+    client.is_attached = true;
+}
+
 pub fn detach(client: *Client) void {
     if (client.monitor) |monitor| {
+        monitor_mod.invalidate_tiled(monitor);
         var current_ptr: *?*Client = &monitor.clients;
         while (current_ptr.*) |current| {
             if (current == client) {
                 current_ptr.* = client.next;
+                monitor_mod.uncount_client(monitor, client.tags, client.is_urgent);
+                client.is_attached = false;
                 return;
             }
             current_ptr = &current.next;
@@ -95,7 +171,6 @@ pub fn detach_stack(client: *Client) void {
 }
 
 pub fn window_to_client(window: xlib.Window) ?*Client {
-    const monitor_mod = @import("monitor.zig");
     var current_monitor = monitor_mod.monitors;
     while (current_monitor) |monitor| {
         var current_client = monitor.clients;
@@ -121,6 +196,33 @@ pub fn next_tiled(client: ?*Client) ?*Client {
     return null;
 }
 
+pub fn get_size_hints(client: *const Client) geometry.Size_Hints {
+    return .{
+        .base_width = client.base_width,
+        .base_height = client.base_height,
+        .increment_width = client.increment_width,
+        .increment_height = client.increment_height,
+        .min_width = client.min_width,
+        .min_height = client.min_height,
+        .max_width = client.max_width,
+        .max_height = client.max_height,
+        .min_aspect = client.min_aspect,
+        .max_aspect = client.max_aspect,
+    };
+}
+
+pub fn to_tiled(client: *const Client) geometry.Tiled {
+    return .{
+        .window = client.window,
+        .x = client.x,
+        .y = client.y,
+        .width = client.width,
+        .height = client.height,
+        .border_width = client.border_width,
+        .hints = get_size_hints(client),
+    };
+}
+
 pub fn is_visible(client: *Client) bool {
     if (client.monitor) |monitor| {
         return (client.tags & monitor.tagset[monitor.sel_tags]) != 0;
@@ -152,16 +254,45 @@ pub fn attach_aside(client: *Client) void {
     }
     client.next = at.?.next;
     at.?.next = client;
+    if (client.monitor) |monitor| {
+        monitor_mod.invalidate_tiled(monitor);
+        mark_attached(client, monitor);
+    }
 }
 
-pub fn count_tiled(monitor: *Monitor) u32 {
-    var count: u32 = 0;
-    var current = next_tiled(monitor.clients);
-    while (current) |client| {
-        count += 1;
-        current = next_tiled(client.next);
+pub fn set_tags(client: *Client, tags: u32) void {
+    const monitor = client.monitor orelse {
+        client.tags = tags;
+        return;
+    };
+    if (client.is_attached) {
+        monitor_mod.uncount_client(monitor, client.tags, client.is_urgent);
+        monitor_mod.count_client(monitor, tags, client.is_urgent);
+    }
+    client.tags = tags;
+    monitor_mod.invalidate_tiled(monitor);
+}
+
+pub fn set_urgent(client: *Client, urgent: bool) void {
+    if (client.is_urgent == urgent) return;
+    if (client.is_attached) {
+        if (client.monitor) |monitor| {
+            monitor_mod.uncount_client(monitor, client.tags, client.is_urgent);
+            monitor_mod.count_client(monitor, client.tags, urgent);
+        }
+    }
+    client.is_urgent = urgent;
+}
+
+pub fn set_floating(client: *Client, floating: bool) void {
+    client.is_floating = floating;
+    if (client.monitor) |monitor| {
+        monitor_mod.invalidate_tiled(monitor);
     }
-    return count;
+}
+
+pub fn count_tiled(monitor: *Monitor) u32 {
+    return @intCast(monitor_mod.tiled_clients(monitor).len);
 }
 
 pub fn tiled_window_at(exclude: *Client, monitor: *Monitor, point_x: i32, point_y: i32) ?*Client {
@@ -195,6 +326,7 @@ pub fn insert_before(client: *Client, target: *Client) void {
     if (monitor.clients == target) {
         client.next = target;
         monitor.clients = client;
+        mark_attached(client, monitor);
         return;
     }
 
@@ -203,6 +335,7 @@ pub fn insert_before(client: *Client, target: *Client) void {
         if (iter.next == target) {
             client.next = target;
             iter.next = client;
+            mark_attached(client, monitor);
             return;
         }
         current = iter.next;
@@ -212,6 +345,7 @@ pub fn insert_before(client: *Client, target: *Client) void {
 pub fn swap_clients(client_a: *Client, client_b: *Client) void {
     const monitor = client_a.monitor orelse return;
     if (client_b.monitor != monitor) return;
+    monitor_mod.invalidate_tiled(monitor);
 
     var prev_a: ?*Client = null;
     var prev_b: ?*Client = null;
@@ -0,0 +1,86 @@
+const std = @import("std");
+const xlib = @import("x11/xlib.zig");
+const monitor_mod = @import("monitor.zig");
+
+var allocator: std.mem.Allocator = undefined;
+var display_handle: ?*xlib.Display = null;
+var root_window: xlib.Window = 0;
+var list_atom: xlib.Atom = 0;
+var stacking_atom: xlib.Atom = 0;
+
+var windows: std.ArrayListUnmanaged(xlib.Window) = .{};
+var stacking: std.ArrayListUnmanaged(xlib.Window) = .{};
+var scratch: std.ArrayListUnmanaged(xlib.Window) = .{};
+
+pub fn init(alloc: std.mem.Allocator, display: *xlib.Display, root: xlib.Window, client_list: xlib.Atom, client_list_stacking: xlib.Atom) void {
+    allocator = alloc;
+    display_handle = display;
+    root_window = root;
+    list_atom = client_list;
+    stacking_atom = client_list_stacking;
+    windows.clearRetainingCapacity();
+    stacking.clearRetainingCapacity();
+    _ = xlib.XDeleteProperty(display, root, list_atom);
+    _ = xlib.XDeleteProperty(display, root, stacking_atom);
+}
+
+pub fn deinit() void {
+    windows.deinit(allocator);
+    stacking.deinit(allocator);
+    scratch.deinit(allocator);
+    display_handle = null;
+}
+
+pub fn add(window: xlib.Window) void {
+    const display = display_handle orelse return;
+    if (std.mem.indexOfScalar(xlib.Window, windows.items, window) != null) return;
+
+    windows.append(allocator, window) catch return;
+    stacking.append(allocator, window) catch {};
+    append(display, list_atom, window);
+    append(display, stacking_atom, window);
+}
+
+pub fn remove(window: xlib.Window) void {
+    const display = display_handle orelse return;
+
+    if (std.mem.indexOfScalar(xlib.Window, windows.items, window)) |index| {
+        _ = windows.orderedRemove(index);
+        write(display, list_atom, windows.items);
+    }
+    if (std.mem.indexOfScalar(xlib.Window, stacking.items, window)) |index| {
+        _ = stacking.orderedRemove(index);
+        write(display, stacking_atom, stacking.items);
+    }
+}
+
+pub fn sync_stacking() void {
+    const display = display_handle orelse return;
+
+    scratch.clearRetainingCapacity();
+    var current_monitor = monitor_mod.monitors;
+    while (current_monitor) |monitor| {
+        const start = scratch.items.len;
+        var current = monitor.stack;
+        while (current) |client| {
+            scratch.append(allocator, client.window) catch return;
+            current = client.stack_next;
+        }
+        std.mem.reverse(xlib.Window, scratch.items[start..]);
+        current_monitor = monitor.next;
+    }
+
+    if (std.mem.eql(xlib.Window, scratch.items, stacking.items)) return;
+
+    std.mem.swap(std.ArrayListUnmanaged(xlib.Window), &scratch, &stacking);
+    write(display, stacking_atom, stacking.items);
+}
+
+fn append(display: *xlib.Display, atom: xlib.Atom, window: xlib.Window) void {
+    var value = window;
+    _ = xlib.XChangeProperty(display, root_window, atom, xlib.XA_WINDOW, 32, xlib.PropModeAppend, @ptrCast(&value), 1);
+}
+
+fn write(display: *xlib.Display, atom: xlib.Atom, items: []const xlib.Window) void {
+    _ = xlib.XChangeProperty(display, root_window, atom, xlib.XA_WINDOW, 32, xlib.PropModeReplace, @ptrCast(items.ptr), @intCast(items.len));
+}
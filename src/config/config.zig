@@ -1,4 +1,5 @@
 const std = @import("std");
+const spawn = @import("../spawn.zig");
 
 pub const Action = enum {
     spawn_terminal,
@@ -40,16 +41,10 @@ pub const Keybind = struct {
     action: Action,
     int_arg: i32 = 0,
     str_arg: ?[]const u8 = null,
+    command: ?*const spawn.Command = null,
 };
 
-pub const Rule = struct {
-    class: ?[]const u8,
-    instance: ?[]const u8,
-    title: ?[]const u8,
-    tags: u32,
-    is_floating: bool,
-    monitor: i32,
-};
+pub const Rule = @import("../rules.zig").Rule;
 
 pub const Block_Type = enum {
     static,
@@ -59,6 +54,9 @@ pub const Block_Type = enum {
     battery,
     cpu_temp,
     pulseaudio,
+    cpu_usage,
+    net_rate,
+    file,
 };
 
 pub const ClickTarget = enum {
@@ -98,6 +96,9 @@ pub const Block = struct {
     format_medium: ?[]const u8 = null,
     format_high: ?[]const u8 = null,
     mixer_name: ?[]const u8 = null,
+    per_core: bool = false,
+    interface: ?[]const u8 = null,
+    path: ?[]const u8 = null,
 };
 
 pub const ColorScheme = struct {
@@ -111,6 +112,7 @@ pub const Config = struct {
 
     terminal: []const u8 = "st",
     font: []const u8 = "monospace:size=10",
+    bar_shm: bool = false,
     tags: [9][]const u8 = .{ "1", "2", "3", "4", "5", "6", "7", "8", "9" },
 
     border_width: i32 = 2,
@@ -123,6 +125,9 @@ pub const Config = struct {
     gap_outer_v: i32 = 5,
 
     auto_tile: bool = false,
+    hide_unmap: bool = false,
+    log_level: []const u8 = "info",
+    log_file: ?[]const u8 = null,
 
     layout_tile_symbol: []const u8 = "[]=",
     layout_monocle_symbol: []const u8 = "[M]",
@@ -1339,6 +1339,40 @@ void goon_destroy(Goon_Ctx *ctx) {
     free(ctx);
 }
 
+size_t goon_memory_usage(Goon_Ctx *ctx) {
+    if (!ctx) return 0;
+
+    size_t total = sizeof(Goon_Ctx);
+
+    for (Goon_Binding *b = ctx->env; b; b = b->next) {
+        total += sizeof(Goon_Binding);
+        if (b->name) total += strlen(b->name) + 1;
+    }
+
+    for (Goon_Value *v = ctx->values; v; v = v->next_alloc) {
+        total += sizeof(Goon_Value);
+        if (v->type == GOON_STRING && v->data.string) {
+            total += strlen(v->data.string) + 1;
+        } else if (v->type == GOON_LIST && v->data.list.items) {
+            total += v->data.list.cap * sizeof(Goon_Value *);
+        } else if (v->type == GOON_LAMBDA) {
+            total += v->data.lambda.param_count * sizeof(char *);
+            for (size_t i = 0; i < v->data.lambda.param_count; i++) {
+                if (v->data.lambda.params[i]) total += strlen(v->data.lambda.params[i]) + 1;
+            }
+            if (v->data.lambda.body) total += strlen(v->data.lambda.body) + 1;
+        }
+    }
+
+    for (Goon_Record_Field *f = ctx->fields; f; f = f->next) {
+        total += sizeof(Goon_Record_Field);
+        if (f->key) total += strlen(f->key) + 1;
+    }
+
+    if (ctx->base_path) total += strlen(ctx->base_path) + 1;
+    return total;
+}
+
 void goon_set_userdata(Goon_Ctx *ctx, void *userdata) {
     ctx->userdata = userdata;
 }
@@ -81,6 +81,7 @@ struct Goon_Ctx {
 
 Goon_Ctx *goon_create(void);
 void goon_destroy(Goon_Ctx *ctx);
+size_t goon_memory_usage(Goon_Ctx *ctx);
 
 void goon_set_userdata(Goon_Ctx *ctx, void *userdata);
 void *goon_get_userdata(Goon_Ctx *ctx);
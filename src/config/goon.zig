@@ -36,6 +36,10 @@ pub fn deinit() void {
     config = null;
 }
 
+pub fn memory_usage() usize {
+    return c.goon_memory_usage(ctx);
+}
+
 pub fn load_file(path: []const u8) bool {
     const context = ctx orelse return false;
     var path_buf: [512]u8 = undefined;
@@ -191,7 +195,7 @@ fn key_name_to_keysym(name: []const u8) ?u64 {
     return null;
 }
 
-fn parse_action(name: []const u8) ?Action {
+pub fn parse_action(name: []const u8) ?Action {
     const action_map = .{
         .{ "spawn-terminal", Action.spawn_terminal },
         .{ "spawn", Action.spawn },
@@ -294,6 +298,22 @@ fn apply_config(root: ?*c.Goon_Value) void {
         cfg.auto_tile = at;
     }
 
+    if (get_bool(c.goon_record_get(root, "bar_shm"))) |shm| {
+        cfg.bar_shm = shm;
+    }
+
+    if (get_bool(c.goon_record_get(root, "hide_unmap"))) |hide| {
+        cfg.hide_unmap = hide;
+    }
+
+    if (get_string(c.goon_record_get(root, "log_level"))) |level| {
+        cfg.log_level = level;
+    }
+
+    if (get_string(c.goon_record_get(root, "log_file"))) |path| {
+        cfg.log_file = path;
+    }
+
     apply_schemes_config(root, cfg);
     apply_bar_config(root, cfg);
     apply_keys_config(root, cfg);
@@ -381,6 +401,18 @@ fn apply_bar_config(root: ?*c.Goon_Value, cfg: *Config) void {
             block.format_low = get_string(c.goon_record_get(block_rec, "fmt_low"));
             block.format_medium = get_string(c.goon_record_get(block_rec, "fmt_medium"));
             block.format_high = get_string(c.goon_record_get(block_rec, "fmt_high"));
+        } else if (std.mem.eql(u8, type_str, "cpu_usage")) {
+            block.block_type = .cpu_usage;
+            block.format = get_string(c.goon_record_get(block_rec, "fmt")) orelse "";
+            block.per_core = get_bool(c.goon_record_get(block_rec, "per_core")) orelse false;
+        } else if (std.mem.eql(u8, type_str, "net_rate")) {
+            block.block_type = .net_rate;
+            block.format = get_string(c.goon_record_get(block_rec, "fmt")) orelse "";
+            block.interface = get_string(c.goon_record_get(block_rec, "device"));
+        } else if (std.mem.eql(u8, type_str, "file")) {
+            block.block_type = .file;
+            block.format = get_string(c.goon_record_get(block_rec, "fmt")) orelse "";
+            block.path = get_string(c.goon_record_get(block_rec, "path"));
         } else {
             continue;
         }
@@ -0,0 +1,397 @@
+const std = @import("std");
+const posix = std.posix;
+const linux = std.os.linux;
+const config_mod = @import("config/config.zig");
+const log = @import("log.zig");
+
+pub const max_clients = 16;
+pub const max_pollfds = max_clients + 1;
+
+const read_capacity = 1024;
+const write_capacity = 64 * 1024;
+const event_capacity = 1024;
+
+pub const Event = enum(u5) { focus, tag, title, layout, monitor };
+
+pub const Handlers = struct {
+    parse_action: *const fn ([]const u8) ?config_mod.Action,
+    run_action: *const fn (config_mod.Action, i32, ?[]const u8) void,
+    query: *const fn ([]const u8, *std.Io.Writer) std.Io.Writer.Error!bool,
+};
+
+const Connection = struct {
+    fd: posix.socket_t,
+    read_buffer: [read_capacity]u8 = undefined,
+    read_len: usize = 0,
+    write_buffer: [write_capacity]u8 = undefined,
+    write_len: usize = 0,
+    subscriptions: u32 = 0,
+    closing: bool = false,
+};
+
+var allocator: std.mem.Allocator = undefined;
+var handlers: ?Handlers = null;
+var listen_fd: posix.socket_t = -1;
+var connections: [max_clients]?*Connection = [_]?*Connection{null} ** max_clients;
+var subscribed_events: u32 = 0;
+var path_buffer: [std.fs.max_path_bytes]u8 = undefined;
+var socket_path: ?[]const u8 = null;
+
+pub fn init(alloc: std.mem.Allocator, ipc_handlers: Handlers) void {
+    allocator = alloc;
+    handlers = ipc_handlers;
+
+    const path = build_path() orelse return;
+    posix.unlink(path) catch {};
+
+    const address = std.net.Address.initUnix(path) catch {
+        log.warn(.ipc, "socket path too long: {s}", .{path});
+        return;
+    };
+    const fd = posix.socket(posix.AF.UNIX, posix.SOCK.STREAM | posix.SOCK.NONBLOCK | posix.SOCK.CLOEXEC, 0) catch |err| {
+        log.warn(.ipc, "socket failed: {s}", .{@errorName(err)});
+        return;
+    };
+    posix.bind(fd, &address.any, address.getOsSockLen()) catch |err| {
+        log.warn(.ipc, "bind {s} failed: {s}", .{ path, @errorName(err) });
+        posix.close(fd);
+        return;
+    };
+    posix.fchmodat(posix.AT.FDCWD, path, 0o600, 0) catch |err| {
+        log.warn(.ipc, "chmod {s} failed: {s}", .{ path, @errorName(err) });
+        posix.unlink(path) catch {};
+        posix.close(fd);
+        return;
+    };
+    posix.listen(fd, 8) catch |err| {
+        log.warn(.ipc, "listen {s} failed: {s}", .{ path, @errorName(err) });
+        posix.unlink(path) catch {};
+        posix.close(fd);
+        return;
+    };
+
+    listen_fd = fd;
+    socket_path = path;
+    path_buffer[path.len] = 0;
+    _ = std.c.setenv("GOONWM_SOCKET", @ptrCast(&path_buffer), 1);
+}
+
+pub fn deinit() void {
+    for (&connections) |*slot| {
+        if (slot.*) |connection| close_connection(slot, connection);
+    }
+    if (listen_fd >= 0) {
+        posix.close(listen_fd);
+        listen_fd = -1;
+    }
+    if (socket_path) |path| {
+        posix.unlink(path) catch {};
+        socket_path = null;
+    }
+}
+
+fn build_path() ?[]const u8 {
+    const display = posix.getenv("DISPLAY") orelse ":0";
+    const colon = std.mem.lastIndexOfScalar(u8, display, ':') orelse 0;
+    var number = display[@min(colon + 1, display.len)..];
+    if (std.mem.indexOfScalar(u8, number, '.')) |dot| {
+        number = number[0..dot];
+    }
+
+    var dir_buffer: [32]u8 = undefined;
+    const runtime_dir = posix.getenv("XDG_RUNTIME_DIR") orelse fallback: {
+        const dir = std.fmt.bufPrint(&dir_buffer, "/tmp/goonwm-{d}", .{linux.getuid()}) catch return null;
+        if (!ensure_private_dir(dir)) return null;
+        break :fallback dir;
+    };
+    return std.fmt.bufPrint(path_buffer[0 .. path_buffer.len - 1], "{s}/goonwm-{s}.sock", .{ runtime_dir, number }) catch null;
+}
+
+fn ensure_private_dir(dir: []const u8) bool {
+    posix.mkdir(dir, 0o700) catch |err| switch (err) {
+        error.PathAlreadyExists => {},
+        else => {
+            log.warn(.ipc, "mkdir {s} failed: {s}", .{ dir, @errorName(err) });
+            return false;
+        },
+    };
+    const stat = posix.fstatat(posix.AT.FDCWD, dir, posix.AT.SYMLINK_NOFOLLOW) catch |err| {
+        log.warn(.ipc, "stat {s} failed: {s}", .{ dir, @errorName(err) });
+        return false;
+    };
+    if (!posix.S.ISDIR(stat.mode) or stat.uid != linux.getuid() or (stat.mode & 0o077) != 0) {
+        log.warn(.ipc, "{s} is not a private directory, not listening", .{dir});
+        return false;
+    }
+    return true;
+}
+
+pub fn poll_fds(out: []posix.pollfd) usize {
+    reap_connections();
+    if (listen_fd < 0) return 0;
+    out[0] = .{ .fd = listen_fd, .events = posix.POLL.IN, .revents = 0 };
+    var count: usize = 1;
+    for (connections) |slot| {
+        const connection = slot orelse continue;
+        var events: i16 = posix.POLL.IN;
+        if (connection.write_len > 0) events |= posix.POLL.OUT;
+        out[count] = .{ .fd = connection.fd, .events = events, .revents = 0 };
+        count += 1;
+    }
+    return count;
+}
+
+pub fn handle_poll(fds: []const posix.pollfd) void {
+    for (fds) |pollfd| {
+        if (pollfd.revents == 0) continue;
+        if (pollfd.fd == listen_fd) {
+            accept_connections();
+            continue;
+        }
+        for (&connections) |*slot| {
+            const connection = slot.* orelse continue;
+            if (connection.fd != pollfd.fd or connection.closing) continue;
+            if ((pollfd.revents & (posix.POLL.ERR | posix.POLL.HUP | posix.POLL.NVAL)) != 0 and (pollfd.revents & posix.POLL.IN) == 0) {
+                close_connection(slot, connection);
+            } else {
+                if ((pollfd.revents & posix.POLL.OUT) != 0 and !flush_connection(connection)) {
+                    close_connection(slot, connection);
+                    break;
+                }
+                if ((pollfd.revents & posix.POLL.IN) != 0) {
+                    read_connection(slot, connection);
+                }
+            }
+            break;
+        }
+    }
+}
+
+pub fn has_subscribers(event: Event) bool {
+    return (subscribed_events & event_bit(event)) != 0;
+}
+
+pub fn publish(event: Event, comptime format: []const u8, args: anytype) void {
+    if (!has_subscribers(event)) return;
+
+    var buffer: [event_capacity]u8 = undefined;
+    var writer = std.Io.Writer.fixed(&buffer);
+    writer.print("{{\"event\":\"{s}\",", .{@tagName(event)}) catch return;
+    writer.print(format, args) catch return;
+    writer.writeAll("}\n") catch return;
+
+    for (&connections) |*slot| {
+        const connection = slot.* orelse continue;
+        if ((connection.subscriptions & event_bit(event)) == 0) continue;
+        if (connection.closing) continue;
+        if (!queue(connection, writer.buffered()) or !flush_connection(connection)) {
+            connection.closing = true;
+        }
+    }
+}
+
+pub const Json_String = struct {
+    text: []const u8,
+
+    pub fn format(self: Json_String, writer: *std.Io.Writer) std.Io.Writer.Error!void {
+        try write_string(writer, self.text);
+    }
+};
+
+pub fn json(text: []const u8) Json_String {
+    return .{ .text = text };
+}
+
+pub fn write_string(writer: *std.Io.Writer, text: []const u8) std.Io.Writer.Error!void {
+    try writer.writeByte('"');
+    for (text) |char| {
+        switch (char) {
+            '"' => try writer.writeAll("\\\""),
+            '\\' => try writer.writeAll("\\\\"),
+            '\n' => try writer.writeAll("\\n"),
+            '\r' => try writer.writeAll("\\r"),
+            '\t' => try writer.writeAll("\\t"),
+            0...8, 11, 12, 14...0x1f => try writer.print("\\u{x:0>4}", .{char}),
+            else => try writer.writeByte(char),
+        }
+    }
+    try writer.writeByte('"');
+}
+
+fn event_bit(event: Event) u32 {
+    return @as(u32, 1) << @intFromEnum(event);
+}
+
+fn accept_connections() void {
+    while (true) {
+        const fd = posix.accept(listen_fd, null, null, posix.SOCK.NONBLOCK | posix.SOCK.CLOEXEC) catch return;
+        if (!peer_is_owner(fd)) {
+            posix.close(fd);
+            continue;
+        }
+        const slot = free_slot() orelse {
+            posix.close(fd);
+            continue;
+        };
+        const connection = allocator.create(Connection) catch {
+            posix.close(fd);
+            return;
+        };
+        connection.* = .{ .fd = fd };
+        slot.* = connection;
+    }
+}
+
+fn peer_is_owner(fd: posix.socket_t) bool {
+    var credentials: linux.ucred = undefined;
+    posix.getsockopt(fd, posix.SOL.SOCKET, posix.SO.PEERCRED, std.mem.asBytes(&credentials)) catch |err| {
+        log.warn(.ipc, "SO_PEERCRED failed: {s}", .{@errorName(err)});
+        return false;
+    };
+    if (credentials.uid == linux.getuid()) return true;
+    log.warn(.ipc, "rejected connection from uid {d} pid {d}", .{ credentials.uid, credentials.pid });
+    return false;
+}
+
+fn free_slot() ?*?*Connection {
+    for (&connections) |*slot| {
+        if (slot.* == null) return slot;
+    }
+    return null;
+}
+
+fn close_connection(slot: *?*Connection, connection: *Connection) void {
+    posix.close(connection.fd);
+    allocator.destroy(connection);
+    slot.* = null;
+    refresh_subscriptions();
+}
+
+fn reap_connections() void {
+    for (&connections) |*slot| {
+        const connection = slot.* orelse continue;
+        if (connection.closing) close_connection(slot, connection);
+    }
+}
+
+fn refresh_subscriptions() void {
+    subscribed_events = 0;
+    for (connections) |slot| {
+        if (slot) |connection| subscribed_events |= connection.subscriptions;
+    }
+}
+
+fn read_connection(slot: *?*Connection, connection: *Connection) void {
+    while (!connection.closing) {
+        if (connection.read_len == connection.read_buffer.len) {
+            connection.closing = true;
+            break;
+        }
+        const len = posix.read(connection.fd, connection.read_buffer[connection.read_len..]) catch |err| switch (err) {
+            error.WouldBlock => break,
+            else => {
+                connection.closing = true;
+                break;
+            },
+        };
+        if (len == 0) {
+            connection.closing = true;
+            break;
+        }
+        connection.read_len += len;
+        handle_lines(connection);
+    }
+
+    if (!connection.closing and !flush_connection(connection)) {
+        connection.closing = true;
+    }
+    if (connection.closing) {
+        close_connection(slot, connection);
+    }
+}
+
+fn handle_lines(connection: *Connection) void {
+    var start: usize = 0;
+    while (std.mem.indexOfScalarPos(u8, connection.read_buffer[0..connection.read_len], start, '\n')) |newline| {
+        const line = std.mem.trim(u8, connection.read_buffer[start..newline], " \r\t");
+        start = newline + 1;
+        if (line.len == 0) continue;
+        if (connection.closing or !handle_request(connection, line)) {
+            connection.closing = true;
+            return;
+        }
+    }
+    std.mem.copyForwards(u8, &connection.read_buffer, connection.read_buffer[start..connection.read_len]);
+    connection.read_len -= start;
+}
+
+fn handle_request(connection: *Connection, line: []const u8) bool {
+    const active = handlers orelse return false;
+    var words = std.mem.tokenizeScalar(u8, line, ' ');
+    const verb = words.next() orelse return true;
+
+    if (std.mem.eql(u8, verb, "action")) {
+        const name = words.next() orelse return respond_error(connection, "missing action");
+        const action = active.parse_action(name) orelse return respond_error(connection, "unknown action");
+        var int_arg: i32 = 0;
+        var str_arg: ?[]const u8 = null;
+        if (words.peek()) |arg| {
+            if (std.fmt.parseInt(i32, arg, 10)) |value| {
+                int_arg = value;
+                _ = words.next();
+            } else |_| {}
+        }
+        const rest = std.mem.trim(u8, words.rest(), " ");
+        if (rest.len > 0) str_arg = rest;
+        active.run_action(action, int_arg, str_arg);
+        return queue(connection, "{\"ok\":true}\n");
+    }
+
+    if (std.mem.eql(u8, verb, "query")) {
+        const what = words.next() orelse return respond_error(connection, "missing query");
+        var writer = std.Io.Writer.fixed(connection.write_buffer[connection.write_len..]);
+        const known = active.query(what, &writer) catch return respond_error(connection, "response too large");
+        if (!known) return respond_error(connection, "unknown query");
+        writer.writeByte('\n') catch return respond_error(connection, "response too large");
+        connection.write_len += writer.end;
+        return true;
+    }
+
+    if (std.mem.eql(u8, verb, "subscribe")) {
+        while (words.next()) |name| {
+            const event = std.meta.stringToEnum(Event, name) orelse return respond_error(connection, "unknown event");
+            connection.subscriptions |= event_bit(event);
+        }
+        refresh_subscriptions();
+        return queue(connection, "{\"ok\":true}\n");
+    }
+
+    return respond_error(connection, "unknown request");
+}
+
+fn respond_error(connection: *Connection, message: []const u8) bool {
+    var buffer: [128]u8 = undefined;
+    const line = std.fmt.bufPrint(&buffer, "{{\"ok\":false,\"error\":\"{s}\"}}\n", .{message}) catch return false;
+    return queue(connection, line);
+}
+
+fn queue(connection: *Connection, bytes: []const u8) bool {
+    if (connection.write_len + bytes.len > connection.write_buffer.len) return false;
+    @memcpy(connection.write_buffer[connection.write_len..][0..bytes.len], bytes);
+    connection.write_len += bytes.len;
+    return true;
+}
+
+fn flush_connection(connection: *Connection) bool {
+    var offset: usize = 0;
+    while (offset < connection.write_len) {
+        const sent = posix.send(connection.fd, connection.write_buffer[offset..connection.write_len], posix.MSG.NOSIGNAL) catch |err| switch (err) {
+            error.WouldBlock => break,
+            else => return false,
+        };
+        offset += sent;
+    }
+    std.mem.copyForwards(u8, &connection.write_buffer, connection.write_buffer[offset..connection.write_len]);
+    connection.write_len -= offset;
+    return true;
+}
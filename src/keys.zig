@@ -0,0 +1,102 @@
+const std = @import("std");
+const xlib = @import("x11/xlib.zig");
+const config_mod = @import("config/config.zig");
+
+const Keybind = config_mod.Keybind;
+
+pub const Mode = u8;
+pub const default_mode: Mode = 0;
+
+const keycode_count = 256;
+
+pub const Binding = struct {
+    mode: Mode,
+    keycode: u8,
+    modifiers: u32,
+};
+
+var allocator: std.mem.Allocator = undefined;
+var keysyms: [keycode_count]u64 = [_]u64{0} ** keycode_count;
+var keycodes: std.AutoHashMapUnmanaged(u64, u8) = .{};
+var table: std.AutoHashMapUnmanaged(u64, u32) = .{};
+var current_mode: Mode = default_mode;
+
+pub fn init(alloc: std.mem.Allocator) void {
+    allocator = alloc;
+}
+
+pub fn deinit() void {
+    keycodes.deinit(allocator);
+    table.deinit(allocator);
+}
+
+fn pack(binding: Binding) u64 {
+    return (@as(u64, binding.mode) << 40) | (@as(u64, binding.keycode) << 32) | binding.modifiers;
+}
+
+pub fn unpack(key: u64) Binding {
+    return .{
+        .mode = @truncate(key >> 40),
+        .keycode = @truncate(key >> 32),
+        .modifiers = @truncate(key),
+    };
+}
+
+pub fn refresh_keymap(display: *xlib.Display) void {
+    @memset(&keysyms, 0);
+    keycodes.clearRetainingCapacity();
+
+    var min_keycode: c_int = 0;
+    var max_keycode: c_int = 0;
+    _ = xlib.XDisplayKeycodes(display, &min_keycode, &max_keycode);
+    if (max_keycode < min_keycode) return;
+
+    const count = max_keycode - min_keycode + 1;
+    var per_keycode: c_int = 0;
+    const mapping = xlib.XGetKeyboardMapping(display, @intCast(min_keycode), count, &per_keycode);
+    if (mapping == null or per_keycode <= 0) return;
+    defer _ = xlib.XFree(mapping);
+
+    var offset: usize = 0;
+    while (offset < @as(usize, @intCast(count))) : (offset += 1) {
+        const keycode: usize = @as(usize, @intCast(min_keycode)) + offset;
+        if (keycode >= keycode_count) break;
+        const keysym: u64 = mapping[offset * @as(usize, @intCast(per_keycode))];
+        keysyms[keycode] = keysym;
+        if (keysym == 0) continue;
+        const entry = keycodes.getOrPut(allocator, keysym) catch continue;
+        if (!entry.found_existing) entry.value_ptr.* = @intCast(keycode);
+    }
+}
+
+pub fn keysym_of(keycode: u8) u64 {
+    return keysyms[keycode];
+}
+
+pub fn keycode_of(keysym: u64) ?u8 {
+    return keycodes.get(keysym);
+}
+
+pub fn rebuild(keybinds: []const Keybind) void {
+    table.clearRetainingCapacity();
+    table.ensureTotalCapacity(allocator, @intCast(keybinds.len)) catch {};
+
+    for (keybinds, 0..) |keybind, index| {
+        const keycode = keycode_of(keybind.keysym) orelse continue;
+        const key = pack(.{ .mode = default_mode, .keycode = keycode, .modifiers = keybind.mod_mask });
+        const entry = table.getOrPut(allocator, key) catch continue;
+        if (!entry.found_existing) entry.value_ptr.* = @intCast(index);
+    }
+}
+
+pub fn lookup(keycode: u8, modifiers: u32) ?u32 {
+    return table.get(pack(.{ .mode = current_mode, .keycode = keycode, .modifiers = modifiers }));
+}
+
+pub fn set_mode(mode: Mode) void {
+    current_mode = mode;
+}
+
+pub fn bindings() std.AutoHashMapUnmanaged(u64, u32).KeyIterator {
+    return table.keyIterator();
+}
@@ -0,0 +1,272 @@
+const std = @import("std");
+
+pub const Rect = struct {
+    x: i32 = 0,
+    y: i32 = 0,
+    width: i32 = 0,
+    height: i32 = 0,
+
+    pub fn right(self: Rect) i32 {
+        return self.x + self.width;
+    }
+
+    pub fn bottom(self: Rect) i32 {
+        return self.y + self.height;
+    }
+
+    pub fn is_empty(self: Rect) bool {
+        return self.width <= 0 or self.height <= 0;
+    }
+
+    pub fn overlaps(self: Rect, other: Rect) bool {
+        return self.x < other.right() and other.x < self.right() and self.y < other.bottom() and other.y < self.bottom();
+    }
+
+    pub fn contains(self: Rect, other: Rect) bool {
+        return other.x >= self.x and other.y >= self.y and other.right() <= self.right() and other.bottom() <= self.bottom();
+    }
+};
+
+pub const Area = struct {
+    x: i32,
+    y: i32,
+    width: i32,
+    height: i32,
+    gap_outer_h: i32 = 0,
+    gap_outer_v: i32 = 0,
+    gap_inner_h: i32 = 0,
+    gap_inner_v: i32 = 0,
+    nmaster: i32 = 1,
+    mfact: f32 = 0.55,
+    scroll_offset: i32 = 0,
+    min_size: i32 = 0,
+    size_hints: bool = false,
+
+    pub fn bounds(self: Area) Rect {
+        return .{ .x = self.x, .y = self.y, .width = self.width, .height = self.height };
+    }
+};
+
+pub const Size_Hints = struct {
+    base_width: i32 = 0,
+    base_height: i32 = 0,
+    increment_width: i32 = 0,
+    increment_height: i32 = 0,
+    min_width: i32 = 0,
+    min_height: i32 = 0,
+    max_width: i32 = 0,
+    max_height: i32 = 0,
+    min_aspect: f32 = 0,
+    max_aspect: f32 = 0,
+};
+
+pub const Tiled = struct {
+    window: c_ulong = 0,
+    x: i32 = 0,
+    y: i32 = 0,
+    width: i32 = 0,
+    height: i32 = 0,
+    border_width: i32 = 0,
+    hints: Size_Hints = .{},
+};
+
+pub const Size = struct {
+    width: i32,
+    height: i32,
+};
+
+pub const Placement = struct {
+    rect: Rect = .{},
+    visible: bool = true,
+};
+
+pub fn apply_hints(hints: Size_Hints, width: i32, height: i32) Size {
+    const base_is_min = hints.base_width == hints.min_width and hints.base_height == hints.min_height;
+
+    var adjusted_width = width;
+    var adjusted_height = height;
+
+    if (!base_is_min) {
+        adjusted_width -= hints.base_width;
+        adjusted_height -= hints.base_height;
+    }
+
+    if (hints.min_aspect > 0 and hints.max_aspect > 0) {
+        const width_float: f32 = @floatFromInt(adjusted_width);
+        const height_float: f32 = @floatFromInt(adjusted_height);
+        if (hints.max_aspect < width_float / height_float) {
+            adjusted_width = @intFromFloat(height_float * hints.max_aspect + 0.5);
+        } else if (hints.min_aspect < height_float / width_float) {
+            adjusted_height = @intFromFloat(width_float * hints.min_aspect + 0.5);
+        }
+    }
+
+    if (base_is_min) {
+        adjusted_width -= hints.base_width;
+        adjusted_height -= hints.base_height;
+    }
+
+    if (hints.increment_width > 0) {
+        adjusted_width -= @mod(adjusted_width, hints.increment_width);
+    }
+    if (hints.increment_height > 0) {
+        adjusted_height -= @mod(adjusted_height, hints.increment_height);
+    }
+
+    var size = Size{
+        .width = @max(adjusted_width + hints.base_width, hints.min_width),
+        .height = @max(adjusted_height + hints.base_height, hints.min_height),
+    };
+    if (hints.max_width > 0) {
+        size.width = @min(size.width, hints.max_width);
+    }
+    if (hints.max_height > 0) {
+        size.height = @min(size.height, hints.max_height);
+    }
+    return size;
+}
+
+pub fn constrain(area: Area, client: Tiled, width: i32, height: i32) Size {
+    var size = Size{
+        .width = @max(1, width),
+        .height = @max(1, height),
+    };
+    size.height = @max(size.height, area.min_size);
+    size.width = @max(size.width, area.min_size);
+    if (area.size_hints) {
+        size = apply_hints(client.hints, size.width, size.height);
+    }
+    return size;
+}
+
+fn constrained_rect(area: Area, client: Tiled, x: i32, y: i32, width: i32, height: i32) Rect {
+    const border = 2 * client.border_width;
+    const size = constrain(area, client, width - border, height - border);
+    return .{ .x = x, .y = y, .width = size.width + border, .height = size.height + border };
+}
+
+const Facts = struct {
+    master: f32,
+    stack: f32,
+    master_rest: i32,
+    stack_rest: i32,
+};
+
+fn get_facts(count: u32, nmaster: i32, master_size: i32, stack_size: i32) Facts {
+    const nmaster_count: u32 = @intCast(@max(0, nmaster));
+    const master_facts: f32 = @floatFromInt(@min(count, nmaster_count));
+    const stack_facts: f32 = @floatFromInt(if (count > nmaster_count) count - nmaster_count else 0);
+
+    var master_total: i32 = 0;
+    var stack_total: i32 = 0;
+
+    if (master_facts > 0) {
+        master_total = @as(i32, @intFromFloat(@as(f32, @floatFromInt(master_size)) / master_facts)) * @as(i32, @intFromFloat(master_facts));
+    }
+    if (stack_facts > 0) {
+        stack_total = @as(i32, @intFromFloat(@as(f32, @floatFromInt(stack_size)) / stack_facts)) * @as(i32, @intFromFloat(stack_facts));
+    }
+
+    return .{
+        .master = master_facts,
+        .stack = stack_facts,
+        .master_rest = master_size - master_total,
+        .stack_rest = stack_size - stack_total,
+    };
+}
+
+pub fn tile(area: Area, tiled: []const Tiled, plan: []Placement) void {
+    std.debug.assert(tiled.len == plan.len);
+    const client_count: u32 = @intCast(plan.len);
+    if (client_count == 0) return;
+
+    const nmaster = area.nmaster;
+    const nmaster_count: u32 = @intCast(@max(0, nmaster));
+
+    const master_x: i32 = area.x + area.gap_outer_v;
+    var master_y: i32 = area.y + area.gap_outer_h;
+    const master_height: i32 = area.height - 2 * area.gap_outer_h - area.gap_inner_h * (@as(i32, @intCast(@min(client_count, nmaster_count))) - 1);
+    var master_width: i32 = area.width - 2 * area.gap_outer_v;
+
+    var stack_x: i32 = master_x;
+    var stack_y: i32 = area.y + area.gap_outer_h;
+    const stack_height: i32 = area.height - 2 * area.gap_outer_h - area.gap_inner_h * (@as(i32, @intCast(client_count)) - nmaster - 1);
+    var stack_width: i32 = master_width;
+
+    if (nmaster > 0 and client_count > nmaster_count) {
+        stack_width = @intFromFloat(@as(f32, @floatFromInt(master_width - area.gap_inner_v)) * (1.0 - area.mfact));
+        master_width = master_width - area.gap_inner_v - stack_width;
+        stack_x = master_x + master_width + area.gap_inner_v;
+    }
+
+    const facts = get_facts(client_count, nmaster, master_height, stack_height);
+
+    for (plan, 0..) |*placement, client_index| {
+        const index: u32 = @intCast(client_index);
+        if (index < nmaster_count) {
+            const height = @as(i32, @intFromFloat(@as(f32, @floatFromInt(master_height)) / facts.master)) + (if (@as(i32, @intCast(index)) < facts.master_rest) @as(i32, 1) else @as(i32, 0));
+            placement.* = .{ .rect = constrained_rect(area, tiled[client_index], master_x, master_y, master_width, height) };
+            master_y += placement.rect.height + area.gap_inner_h;
+        } else {
+            const stack_index = index - nmaster_count;
+            const height = @as(i32, @intFromFloat(@as(f32, @floatFromInt(stack_height)) / facts.stack)) + (if (@as(i32, @intCast(stack_index)) < facts.stack_rest) @as(i32, 1) else @as(i32, 0));
+            placement.* = .{ .rect = constrained_rect(area, tiled[client_index], stack_x, stack_y, stack_width, height) };
+            stack_y += placement.rect.height + area.gap_inner_h;
+        }
+    }
+}
+
+pub fn monocle(area: Area, tiled: []const Tiled, plan: []Placement) void {
+    std.debug.assert(tiled.len == plan.len);
+    const rect = Rect{
+        .x = area.x + area.gap_outer_v,
+        .y = area.y + area.gap_outer_h,
+        .width = area.width - 2 * area.gap_outer_v,
+        .height = area.height - 2 * area.gap_outer_h,
+    };
+    for (plan, tiled) |*placement, client| {
+        placement.* = .{ .rect = constrained_rect(area, client, rect.x, rect.y, rect.width, rect.height) };
+    }
+}
+
+pub fn scroll_window_width(area: Area) i32 {
+    const visible_count: u32 = @intCast(@max(1, area.nmaster));
+    const available_width = area.width - 2 * area.gap_outer_v;
+    const total_gaps = area.gap_inner_v * @as(i32, @intCast(if (visible_count > 1) visible_count - 1 else 0));
+    return @divTrunc(available_width - total_gaps, @as(i32, @intCast(visible_count)));
+}
+
+pub fn scroll_step(area: Area) i32 {
+    return scroll_window_width(area) + area.gap_inner_v;
+}
+
+pub fn max_scroll(area: Area, client_count: u32) i32 {
+    const visible_count: u32 = @intCast(@max(1, area.nmaster));
+    if (client_count <= visible_count) return 0;
+    return scroll_step(area) * @as(i32, @intCast(client_count - visible_count));
+}
+
+pub fn scroll(area: Area, tiled: []const Tiled, plan: []Placement) void {
+    std.debug.assert(tiled.len == plan.len);
+    if (plan.len == 0) return;
+
+    const window_width = scroll_window_width(area);
+    const height = area.height - 2 * area.gap_outer_h;
+    const y_pos = area.y + area.gap_outer_h;
+    const screen_left = area.x + area.gap_outer_v;
+    const screen_right = area.x + area.width - area.gap_outer_v;
+
+    var x_pos: i32 = area.x + area.gap_outer_v - area.scroll_offset;
+    for (plan, tiled) |*placement, client| {
+        const window_right = x_pos + window_width;
+        if (window_right > screen_left and x_pos < screen_right) {
+            placement.* = .{ .rect = constrained_rect(area, client, x_pos, y_pos, window_width, height) };
+        } else {
+            placement.* = .{
+                .rect = constrained_rect(area, client, -2 * window_width, y_pos, window_width, height),
+                .visible = false,
+            };
+        }
+        x_pos += window_width + area.gap_inner_v;
+    }
+}
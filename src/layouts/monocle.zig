@@ -3,6 +3,7 @@ const client_mod = @import("../client.zig");
 const monitor_mod = @import("../monitor.zig");
 const xlib = @import("../x11/xlib.zig");
 const tiling = @import("tiling.zig");
+const geometry = @import("geometry.zig");
 
 const Client = client_mod.Client;
 const Monitor = monitor_mod.Monitor;
@@ -13,19 +14,41 @@ pub const layout = monitor_mod.Layout{
 };
 
 pub fn monocle(monitor: *Monitor) void {
-    const gap_h = monitor.gap_outer_h;
-    const gap_v = monitor.gap_outer_v;
+    const area = tiling.layout_area(monitor);
+    if (monitor.monocle_area) |fitted| {
+        if (std.meta.eql(fitted, area)) {
+            const client = top_client(monitor) orelse return;
+            fit(monitor, client);
+            return;
+        }
+    }
+    fit_all(monitor, area);
+}
+
+fn fit_all(monitor: *Monitor, area: geometry.Area) void {
+    const clients = monitor_mod.tiled_clients(monitor);
+    const frames = monitor_mod.tiled_frames(monitor);
+    const plan = monitor_mod.layout_plan(monitor, frames.len) orelse return;
+    geometry.monocle(area, frames, plan);
+    tiling.apply_plan(clients, frames, plan);
+    monitor.monocle_area = area;
+}
+
+pub fn fit(monitor: *Monitor, client: *Client) void {
+    if (client.is_floating or !client_mod.is_visible(client)) return;
+    const clients = monitor_mod.tiled_clients(monitor);
+    const index = std.mem.indexOfScalar(*Client, clients, client) orelse return;
+    const frames = monitor_mod.tiled_frames(monitor)[index..][0..1];
+    var plan: [1]geometry.Placement = undefined;
+    geometry.monocle(tiling.layout_area(monitor), frames, &plan);
+    tiling.apply_plan(clients[index..][0..1], frames, &plan);
+}
 
-    var current = client_mod.next_tiled(monitor.clients);
+fn top_client(monitor: *Monitor) ?*Client {
+    var current = monitor.stack;
     while (current) |client| {
-        tiling.resize(
-            client,
-            monitor.win_x + gap_v,
-            monitor.win_y + gap_h,
-            monitor.win_w - 2 * gap_v - 2 * client.border_width,
-            monitor.win_h - 2 * gap_h - 2 * client.border_width,
-            false,
-        );
-        current = client_mod.next_tiled(client.next);
+        if (!client.is_floating and client_mod.is_visible(client)) return client;
+        current = client.stack_next;
     }
+    return null;
 }
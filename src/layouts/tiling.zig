@@ -2,6 +2,8 @@ const std = @import("std");
 const client_mod = @import("../client.zig");
 const monitor_mod = @import("../monitor.zig");
 const xlib = @import("../x11/xlib.zig");
+const properties = @import("../properties.zig");
+const geometry = @import("geometry.zig");
 
 const Client = client_mod.Client;
 const Monitor = monitor_mod.Monitor;
@@ -30,96 +32,51 @@ pub fn set_bar_height(height: i32) void {
 }
 
 pub fn tile(monitor: *Monitor) void {
-    var gap_outer_h: i32 = 0;
-    var gap_outer_v: i32 = 0;
-    var gap_inner_h: i32 = 0;
-    var gap_inner_v: i32 = 0;
-    var client_count: u32 = 0;
-
-    get_gaps(monitor, &gap_outer_h, &gap_outer_v, &gap_inner_h, &gap_inner_v, &client_count);
-    if (client_count == 0) return;
-
-    const nmaster: i32 = monitor.nmaster;
-    const nmaster_count: u32 = @intCast(@max(0, nmaster));
-
-    const master_x: i32 = monitor.win_x + gap_outer_v;
-    var master_y: i32 = monitor.win_y + gap_outer_h;
-    const master_height: i32 = monitor.win_h - 2 * gap_outer_h - gap_inner_h * (@as(i32, @intCast(@min(client_count, nmaster_count))) - 1);
-    var master_width: i32 = monitor.win_w - 2 * gap_outer_v;
-
-    var stack_x: i32 = master_x;
-    var stack_y: i32 = monitor.win_y + gap_outer_h;
-    const stack_height: i32 = monitor.win_h - 2 * gap_outer_h - gap_inner_h * (@as(i32, @intCast(client_count)) - nmaster - 1);
-    var stack_width: i32 = master_width;
-
-    if (nmaster > 0 and client_count > nmaster_count) {
-        stack_width = @intFromFloat(@as(f32, @floatFromInt(master_width - gap_inner_v)) * (1.0 - monitor.mfact));
-        master_width = master_width - gap_inner_v - stack_width;
-        stack_x = master_x + master_width + gap_inner_v;
-    }
+    const clients = monitor_mod.tiled_clients(monitor);
+    if (clients.len == 0) return;
+    const frames = monitor_mod.tiled_frames(monitor);
+    const plan = monitor_mod.layout_plan(monitor, frames.len) orelse return;
+    geometry.tile(layout_area(monitor), frames, plan);
+    apply_plan(clients, frames, plan);
+}
 
-    var master_facts: f32 = 0;
-    var stack_facts: f32 = 0;
-    var master_rest: i32 = 0;
-    var stack_rest: i32 = 0;
-    get_facts(monitor, master_height, stack_height, &master_facts, &stack_facts, &master_rest, &stack_rest);
+pub fn layout_area(monitor: *Monitor) geometry.Area {
+    return .{
+        .x = monitor.win_x,
+        .y = monitor.win_y,
+        .width = monitor.win_w,
+        .height = monitor.win_h,
+        .gap_outer_h = monitor.gap_outer_h,
+        .gap_outer_v = monitor.gap_outer_v,
+        .gap_inner_h = monitor.gap_inner_h,
+        .gap_inner_v = monitor.gap_inner_v,
+        .nmaster = monitor.nmaster,
+        .mfact = monitor.mfact,
+        .scroll_offset = monitor.scroll_offset,
+        .min_size = bar_height,
+        .size_hints = monitor.lt[monitor.sel_lt] == null,
+    };
+}
 
-    var index: u32 = 0;
-    var current = client_mod.next_tiled(monitor.clients);
-    while (current) |client| : (current = client_mod.next_tiled(client.next)) {
-        if (index < nmaster_count) {
-            const height = @as(i32, @intFromFloat(@as(f32, @floatFromInt(master_height)) / master_facts)) + (if (index < @as(u32, @intCast(master_rest))) @as(i32, 1) else @as(i32, 0)) - 2 * client.border_width;
-            resize(client, master_x, master_y, master_width - 2 * client.border_width, height, false);
-            master_y += get_client_height(client) + gap_inner_h;
+pub fn apply_plan(clients: []const *Client, frames: []geometry.Tiled, plan: []const geometry.Placement) void {
+    for (clients, frames, plan) |client, *frame, placement| {
+        const rect = placement.rect;
+        const width = rect.width - 2 * frame.border_width;
+        const height = rect.height - 2 * frame.border_width;
+        if (placement.visible) {
+            resize(client, rect.x, rect.y, width, height, false);
         } else {
-            const stack_index = index - nmaster_count;
-            const height = @as(i32, @intFromFloat(@as(f32, @floatFromInt(stack_height)) / stack_facts)) + (if (stack_index < @as(u32, @intCast(stack_rest))) @as(i32, 1) else @as(i32, 0)) - 2 * client.border_width;
-            resize(client, stack_x, stack_y, stack_width - 2 * client.border_width, height, false);
-            stack_y += get_client_height(client) + gap_inner_h;
+            resize_client(client, rect.x, rect.y, width, height);
         }
-        index += 1;
+        sync_frame(frame, client);
     }
 }
 
-fn get_gaps(monitor: *Monitor, gap_outer_h: *i32, gap_outer_v: *i32, gap_inner_h: *i32, gap_inner_v: *i32, client_count: *u32) void {
-    var count: u32 = 0;
-    var current = client_mod.next_tiled(monitor.clients);
-    while (current) |client| : (current = client_mod.next_tiled(client.next)) {
-        count += 1;
-    }
-
-    gap_outer_h.* = monitor.gap_outer_h;
-    gap_outer_v.* = monitor.gap_outer_v;
-    gap_inner_h.* = monitor.gap_inner_h;
-    gap_inner_v.* = monitor.gap_inner_v;
-    client_count.* = count;
-}
-
-fn get_facts(monitor: *Monitor, master_size: i32, stack_size: i32, master_factor: *f32, stack_factor: *f32, master_rest: *i32, stack_rest: *i32) void {
-    var count: u32 = 0;
-    var current = client_mod.next_tiled(monitor.clients);
-    while (current) |client| : (current = client_mod.next_tiled(client.next)) {
-        count += 1;
-    }
-
-    const nmaster_count: u32 = @intCast(@max(0, monitor.nmaster));
-    const master_facts: f32 = @floatFromInt(@min(count, nmaster_count));
-    const stack_facts: f32 = @floatFromInt(if (count > nmaster_count) count - nmaster_count else 0);
-
-    var master_total: i32 = 0;
-    var stack_total: i32 = 0;
-
-    if (master_facts > 0) {
-        master_total = @as(i32, @intFromFloat(@as(f32, @floatFromInt(master_size)) / master_facts)) * @as(i32, @intFromFloat(master_facts));
-    }
-    if (stack_facts > 0) {
-        stack_total = @as(i32, @intFromFloat(@as(f32, @floatFromInt(stack_size)) / stack_facts)) * @as(i32, @intFromFloat(stack_facts));
-    }
-
-    master_factor.* = master_facts;
-    stack_factor.* = stack_facts;
-    master_rest.* = master_size - master_total;
-    stack_rest.* = stack_size - stack_total;
+pub fn sync_frame(frame: *geometry.Tiled, client: *const Client) void {
+    frame.x = client.x;
+    frame.y = client.y;
+    frame.width = client.width;
+    frame.height = client.height;
 }
 
 fn get_client_width(client: *Client) i32 {
@@ -172,47 +129,10 @@ pub fn apply_size_hints(client: *Client, target_x: *i32, target_y: *i32, target_
     }
 
     if (client.is_floating or monitor.lt[monitor.sel_lt] == null) {
-        const base_is_min = client.base_width == client.min_width and client.base_height == client.min_height;
-
-        var adjusted_width = target_width.*;
-        var adjusted_height = target_height.*;
-
-        if (!base_is_min) {
-            adjusted_width -= client.base_width;
-            adjusted_height -= client.base_height;
-        }
-
-        if (client.min_aspect > 0 and client.max_aspect > 0) {
-            const width_float: f32 = @floatFromInt(adjusted_width);
-            const height_float: f32 = @floatFromInt(adjusted_height);
-            if (client.max_aspect < width_float / height_float) {
-                adjusted_width = @intFromFloat(height_float * client.max_aspect + 0.5);
-            } else if (client.min_aspect < height_float / width_float) {
-                adjusted_height = @intFromFloat(width_float * client.min_aspect + 0.5);
-            }
-        }
-
-        if (base_is_min) {
-            adjusted_width -= client.base_width;
-            adjusted_height -= client.base_height;
-        }
-
-        if (client.increment_width > 0) {
-            adjusted_width -= @mod(adjusted_width, client.increment_width);
-        }
-        if (client.increment_height > 0) {
-            adjusted_height -= @mod(adjusted_height, client.increment_height);
-        }
-
-        target_width.* = @max(adjusted_width + client.base_width, client.min_width);
-        target_height.* = @max(adjusted_height + client.base_height, client.min_height);
-
-        if (client.max_width > 0) {
-            target_width.* = @min(target_width.*, client.max_width);
-        }
-        if (client.max_height > 0) {
-            target_height.* = @min(target_height.*, client.max_height);
-        }
+        properties.ensure_size_hints(client);
+        const size = geometry.apply_hints(client_mod.get_size_hints(client), target_width.*, target_height.*);
+        target_width.* = size.width;
+        target_height.* = size.height;
     }
 
     return target_x.* != client.x or target_y.* != client.y or target_width.* != client.width or target_height.* != client.height;
@@ -259,6 +179,17 @@ pub fn resize_client(client: *Client, target_x: i32, target_y: i32, target_width
     _ = xlib.XSync(display, xlib.False);
 }
 
+pub fn move_client(client: *Client, target_x: i32, target_y: i32) void {
+    client.old_x = client.x;
+    client.old_y = client.y;
+    client.x = target_x;
+    client.y = target_y;
+
+    const display = display_handle orelse return;
+    _ = xlib.XMoveWindow(display, client.window, target_x, target_y);
+    send_configure(client);
+}
+
 pub fn send_configure(client: *Client) void {
     const display = display_handle orelse return;
 
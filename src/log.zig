@@ -0,0 +1,182 @@
+const std = @import("std");
+
+pub const Level = enum(u8) { debug, info, warn, err };
+
+pub const Category = enum(u8) { core, config, event, client, layout, monitor, bar, x11, ipc };
+
+const message_capacity = 112;
+const record_capacity = 1024;
+const chunk_size = 4096;
+
+const Record = struct {
+    timestamp_ns: u64 = 0,
+    level: Level = .info,
+    category: Category = .core,
+    len: u8 = 0,
+    text: [message_capacity]u8 = undefined,
+};
+
+var records: [record_capacity]Record = [_]Record{.{}} ** record_capacity;
+var head: u64 = 0;
+var flushed: u64 = 0;
+var dropped: u64 = 0;
+var min_level: Level = .info;
+var sink: std.posix.fd_t = std.posix.STDERR_FILENO;
+var owns_sink: bool = false;
+var start_ns: u64 = 0;
+
+pub fn set_level(level: Level) void {
+    min_level = level;
+}
+
+pub fn set_level_name(name: []const u8) void {
+    const level = std.meta.stringToEnum(Level, name) orelse {
+        warn(.config, "unknown log level '{s}'", .{name});
+        return;
+    };
+    set_level(level);
+}
+
+pub fn open_file(path: ?[]const u8) void {
+    flush();
+    if (owns_sink) {
+        std.posix.close(sink);
+        owns_sink = false;
+    }
+    sink = std.posix.STDERR_FILENO;
+
+    const file_path = path orelse return;
+    const file = std.fs.cwd().createFile(file_path, .{ .truncate = false }) catch {
+        warn(.config, "cannot open log file {s}", .{file_path});
+        return;
+    };
+    file.seekFromEnd(0) catch {};
+    sink = file.handle;
+    owns_sink = true;
+}
+
+pub fn debug(category: Category, comptime format: []const u8, args: anytype) void {
+    write(.debug, category, format, args);
+}
+
+pub fn info(category: Category, comptime format: []const u8, args: anytype) void {
+    write(.info, category, format, args);
+}
+
+pub fn warn(category: Category, comptime format: []const u8, args: anytype) void {
+    write(.warn, category, format, args);
+}
+
+pub fn err(category: Category, comptime format: []const u8, args: anytype) void {
+    write(.err, category, format, args);
+}
+
+pub fn write(level: Level, category: Category, comptime format: []const u8, args: anytype) void {
+    if (@intFromEnum(level) < @intFromEnum(min_level)) return;
+
+    if (head - flushed == record_capacity) {
+        flushed += 1;
+        dropped += 1;
+    }
+
+    const record = &records[head % record_capacity];
+    var writer = std.Io.Writer.fixed(&record.text);
+    writer.print(format, args) catch {};
+    record.timestamp_ns = now() -| start_ns;
+    record.level = level;
+    record.category = category;
+    record.len = @intCast(writer.end);
+    head += 1;
+}
+
+pub fn init() void {
+    start_ns = now();
+
+    const handler = std.posix.Sigaction{
+        .handler = .{ .handler = handle_fatal_signal },
+        .mask = std.mem.zeroes(std.posix.sigset_t),
+        .flags = std.posix.SA.RESETHAND,
+    };
+    for ([_]u8{ std.posix.SIG.SEGV, std.posix.SIG.BUS, std.posix.SIG.ILL, std.posix.SIG.FPE, std.posix.SIG.ABRT }) |signal| {
+        std.posix.sigaction(signal, &handler, null);
+    }
+}
+
+fn handle_fatal_signal(signal: c_int) callconv(.c) void {
+    dump_crash();
+    _ = std.posix.system.kill(std.posix.system.getpid(), signal);
+}
+
+pub fn flush() void {
+    var buffer: [chunk_size]u8 = undefined;
+    while (flushed < head) {
+        if (!writable()) return;
+
+        var len: usize = 0;
+        if (dropped > 0) {
+            len = (std.fmt.bufPrint(&buffer, "[log] dropped {d} records\n", .{dropped}) catch "").len;
+            dropped = 0;
+        }
+        while (flushed < head) {
+            const line = format_record(&records[flushed % record_capacity], buffer[len..]) orelse break;
+            len += line.len;
+            flushed += 1;
+        }
+        write_all(buffer[0..len]);
+    }
+}
+
+pub fn dump_crash() void {
+    var buffer: [chunk_size]u8 = undefined;
+    write_fd(std.posix.STDERR_FILENO, "goonwm log ring (most recent last)\n");
+
+    const first = if (head > record_capacity) head - record_capacity else 0;
+    var index = first;
+    while (index < head) : (index += 1) {
+        const line = format_record(&records[index % record_capacity], &buffer) orelse continue;
+        write_fd(std.posix.STDERR_FILENO, line);
+    }
+}
+
+pub fn deinit() void {
+    flush();
+    if (owns_sink) {
+        std.posix.close(sink);
+        owns_sink = false;
+        sink = std.posix.STDERR_FILENO;
+    }
+}
+
+fn format_record(record: *const Record, buffer: []u8) ?[]const u8 {
+    const seconds = record.timestamp_ns / std.time.ns_per_s;
+    const micros = (record.timestamp_ns % std.time.ns_per_s) / std.time.ns_per_us;
+    return std.fmt.bufPrint(buffer, "[{d:>6}.{d:0>6}] {s:<5} {s:<7} {s}\n", .{
+        seconds,
+        micros,
+        @tagName(record.level),
+        @tagName(record.category),
+        record.text[0..record.len],
+    }) catch null;
+}
+
+fn writable() bool {
+    var fds = [_]std.posix.pollfd{.{ .fd = sink, .events = std.posix.POLL.OUT, .revents = 0 }};
+    const ready = std.posix.poll(&fds, 0) catch return false;
+    return ready > 0 and (fds[0].revents & std.posix.POLL.OUT) != 0;
+}
+
+fn write_all(bytes: []const u8) void {
+    write_fd(sink, bytes);
+}
+
+fn write_fd(fd: std.posix.fd_t, bytes: []const u8) void {
+    var offset: usize = 0;
+    while (offset < bytes.len) {
+        offset += std.posix.write(fd, bytes[offset..]) catch return;
+    }
+}
+
+fn now() u64 {
+    const ts = std.posix.clock_gettime(.MONOTONIC) catch return 0;
+    return @as(u64, @intCast(ts.sec)) * std.time.ns_per_s + @as(u64, @intCast(ts.nsec));
+}
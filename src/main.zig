@@ -2,6 +2,8 @@ const std = @import("std");
 const display_mod = @import("x11/display.zig");
 const events = @import("x11/events.zig");
 const xlib = @import("x11/xlib.zig");
+const event_trace = @import("x11/event_trace.zig");
+const stub_server = @import("x11/stub_server.zig");
 const client_mod = @import("client.zig");
 const monitor_mod = @import("monitor.zig");
 const tiling = @import("layouts/tiling.zig");
@@ -14,6 +16,15 @@ const blocks_mod = @import("bar/blocks/blocks.zig");
 const config_mod = @import("config/config.zig");
 const goon = @import("config/goon.zig");
 const pulseaudio = @import("bar/blocks/pulseaudio.zig");
+const client_list = @import("client_list.zig");
+const properties = @import("properties.zig");
+const trace = @import("trace.zig");
+const log = @import("log.zig");
+const ipc = @import("ipc.zig");
+const spawn = @import("spawn.zig");
+const keys = @import("keys.zig");
+const rules = @import("rules.zig");
+const memory = @import("memory.zig");
 
 const Display = display_mod.Display;
 const Client = client_mod.Client;
@@ -36,6 +47,32 @@ var net_active_window: xlib.Atom = 0;
 var net_wm_window_type: xlib.Atom = 0;
 var net_wm_window_type_dialog: xlib.Atom = 0;
 var net_client_list: xlib.Atom = 0;
+var net_client_list_stacking: xlib.Atom = 0;
+
+var utf8_string: xlib.Atom = 0;
+
+const Atom_Target = struct {
+    name: [*:0]const u8,
+    target: *xlib.Atom,
+};
+
+const atom_targets = [_]Atom_Target{
+    .{ .name = "WM_PROTOCOLS", .target = &wm_protocols },
+    .{ .name = "WM_DELETE_WINDOW", .target = &wm_delete },
+    .{ .name = "WM_STATE", .target = &wm_state },
+    .{ .name = "WM_TAKE_FOCUS", .target = &wm_take_focus },
+    .{ .name = "_NET_ACTIVE_WINDOW", .target = &net_active_window },
+    .{ .name = "_NET_SUPPORTED", .target = &net_supported },
+    .{ .name = "_NET_WM_NAME", .target = &net_wm_name },
+    .{ .name = "_NET_WM_STATE", .target = &net_wm_state },
+    .{ .name = "_NET_SUPPORTING_WM_CHECK", .target = &net_wm_check },
+    .{ .name = "_NET_WM_STATE_FULLSCREEN", .target = &net_wm_state_fullscreen },
+    .{ .name = "_NET_WM_WINDOW_TYPE", .target = &net_wm_window_type },
+    .{ .name = "_NET_WM_WINDOW_TYPE_DIALOG", .target = &net_wm_window_type_dialog },
+    .{ .name = "_NET_CLIENT_LIST", .target = &net_client_list },
+    .{ .name = "_NET_CLIENT_LIST_STACKING", .target = &net_client_list_stacking },
+    .{ .name = "UTF8_STRING", .target = &utf8_string },
+};
 
 var wm_check_window: xlib.Window = 0;
 
@@ -63,7 +100,13 @@ var numlock_mask: c_uint = 0;
 
 var config: config_mod.Config = undefined;
 var display_global: ?*Display = null;
+var scanning: bool = false;
+var startup_timer: ?std.time.Timer = null;
 var config_path_global: ?[]const u8 = null;
+var terminal_command: ?*const spawn.Command = null;
+var rule_matcher: ?rules.Matcher = null;
+var randr_event_base: c_int = -1;
+var geometry_dirty: bool = false;
 
 var scroll_animation: animations.Scroll_Animation = .{};
 var animation_config: animations.Animation_Config = .{ .duration_ms = 150, .easing = .ease_out };
@@ -71,22 +114,37 @@ var animation_config: animations.Animation_Config = .{ .duration_ms = 150, .easi
 pub fn main() !void {
     const allocator = gpa.allocator();
     defer _ = gpa.deinit();
+    memory.init(allocator);
+    log.init();
+    defer log.deinit();
+    spawn.init(memory.allocator(.spawn));
+    defer spawn.deinit();
+    keys.init(memory.allocator(.keys));
+    defer keys.deinit();
 
-    std.debug.print("goonwm starting\n", .{});
+    log.info(.core, "goonwm starting", .{});
 
     var config_path: ?[]const u8 = null;
+    var record_path: ?[]const u8 = null;
+    var replay_path: ?[]const u8 = null;
     var args = std.process.args();
     _ = args.skip();
     while (args.next()) |arg| {
         if (std.mem.eql(u8, arg, "-c") or std.mem.eql(u8, arg, "--config")) {
             config_path = args.next();
+        } else if (std.mem.eql(u8, arg, "--startup-profile")) {
+            startup_timer = std.time.Timer.start() catch null;
+        } else if (std.mem.eql(u8, arg, "--record")) {
+            record_path = args.next();
+        } else if (std.mem.eql(u8, arg, "--replay")) {
+            replay_path = args.next();
         } else if (std.mem.eql(u8, arg, "-h") or std.mem.eql(u8, arg, "--help")) {
-            std.debug.print("usage: goonwm [-c config.goon]\n", .{});
+            std.debug.print("usage: goonwm [-c config.goon] [--startup-profile] [--record trace | --replay trace]\n", .{});
             return;
         }
     }
 
-    config = config_mod.Config.init(allocator);
+    config = config_mod.Config.init(memory.allocator(.config));
     defer config.deinit();
     config_mod.set_config(&config);
 
@@ -99,87 +157,147 @@ pub fn main() !void {
         if (loaded) {
             config_path_global = config_path;
             if (config_path) |path| {
-                std.debug.print("loaded config from {s}\n", .{path});
+                log.info(.config, "loaded config from {s}", .{path});
             } else {
-                std.debug.print("loaded config from ~/.config/goonwm/config.goon\n", .{});
+                log.info(.config, "loaded config from ~/.config/goonwm/config.goon", .{});
             }
             apply_config_values();
         } else {
-            std.debug.print("no config found, using defaults\n", .{});
+            log.warn(.config, "no config found, using defaults", .{});
             setup_default_keybinds();
         }
     } else {
-        std.debug.print("failed to init goon, using defaults\n", .{});
+        log.warn(.config, "failed to init goon, using defaults", .{});
         setup_default_keybinds();
     }
+    profile_phase("config");
+
+    if (replay_path != null) {
+        const name = stub_server.start() catch |err| {
+            log.err(.core, "failed to start stub x server: {}", .{err});
+            return;
+        };
+        var display_name: [32]u8 = undefined;
+        _ = std.c.setenv("DISPLAY", std.fmt.bufPrintZ(&display_name, "{s}", .{name}) catch return, 1);
+        spawn.disable();
+    }
+    defer stub_server.stop();
 
     var display = Display.open() catch |err| {
-        std.debug.print("failed to open display: {}\n", .{err});
+        log.err(.core, "failed to open display: {}", .{err});
         return;
     };
     defer display.close();
 
     display_global = &display;
 
-    std.debug.print("display opened: screen={d} root=0x{x}\n", .{ display.screen, display.root });
-    std.debug.print("screen size: {d}x{d}\n", .{ display.screen_width(), display.screen_height() });
+    log.info(.core, "display opened: screen={d} root=0x{x}", .{ display.screen, display.root });
+    log.info(.core, "screen size: {d}x{d}", .{ display.screen_width(), display.screen_height() });
 
     display.become_window_manager() catch |err| {
-        std.debug.print("failed to become window manager: {}\n", .{err});
+        log.err(.core, "failed to become window manager: {}", .{err});
         return;
     };
 
-    std.debug.print("successfully became window manager\n", .{});
+    log.info(.core, "successfully became window manager", .{});
+    _ = std.posix.fcntl(xlib.XConnectionNumber(display.handle), std.posix.F.SETFD, std.posix.FD_CLOEXEC) catch 0;
+    trace.init(display.handle);
+    if (replay_path == null) {
+        ipc.init(memory.allocator(.ipc), .{
+            .parse_action = &goon.parse_action,
+            .run_action = &run_ipc_action,
+            .query = &write_ipc_query,
+        });
+    }
+    profile_phase("connect");
 
     setup_atoms(&display);
+    profile_phase("atoms");
     setup_cursors(&display);
-    client_mod.init(allocator);
-    monitor_mod.init(allocator);
+    client_mod.init(memory.allocator(.client));
+    monitor_mod.init(memory.allocator(.monitor));
     monitor_mod.set_root_window(display.root, display.handle);
     tiling.set_display(display.handle);
     tiling.set_screen_size(display.screen_width(), display.screen_height());
 
     setup_monitors(&display);
-    setup_bars(allocator, &display);
+    profile_phase("xinerama");
+    if (replay_path == null) {
+        setup_bars(memory.allocator(.bar), &display);
+    }
+    profile_phase("bars");
+    prepare_commands();
+    compile_rules();
+    keys.refresh_keymap(display.handle);
     grab_keybinds(&display);
     scan_existing_windows(&display);
+    profile_phase("scan");
+    arrange_all();
+    focus(&display, null);
+    _ = xlib.XSync(display.handle, xlib.False);
+    profile_phase("first arrange");
 
-    std.debug.print("entering event loop\n", .{});
-    run_event_loop(&display);
+    if (replay_path) |path| {
+        run_replay(&display, path);
+    } else {
+        if (record_path) |path| {
+            event_trace.start(path) catch |err| log.warn(.core, "failed to record events to {s}: {}", .{ path, err });
+        }
+        log.info(.core, "entering event loop", .{});
+        run_event_loop(&display);
+        event_trace.finish();
+    }
 
+    ipc.deinit();
+    release_hidden_clients(&display);
+    if (rule_matcher) |*matcher| matcher.deinit();
+    client_list.deinit();
+    client_mod.deinit();
+    monitor_mod.deinit();
     goon.deinit();
-    std.debug.print("goonwm exiting\n", .{});
+    log.info(.core, "goonwm exiting", .{});
+}
+
+fn profile_phase(name: []const u8) void {
+    if (startup_timer) |*timer| {
+        const elapsed: f64 = @floatFromInt(timer.lap());
+        log.info(.core, "startup: {s}: {d:.3}ms", .{ name, elapsed / std.time.ns_per_ms });
+    }
+}
+
+fn arrange_all() void {
+    var current = monitor_mod.monitors;
+    while (current) |monitor| {
+        arrange(monitor);
+        current = monitor.next;
+    }
 }
 
 fn setup_atoms(display: *Display) void {
-    wm_protocols = xlib.XInternAtom(display.handle, "WM_PROTOCOLS", xlib.False);
-    wm_delete = xlib.XInternAtom(display.handle, "WM_DELETE_WINDOW", xlib.False);
-    wm_state = xlib.XInternAtom(display.handle, "WM_STATE", xlib.False);
-    wm_take_focus = xlib.XInternAtom(display.handle, "WM_TAKE_FOCUS", xlib.False);
-
-    net_active_window = xlib.XInternAtom(display.handle, "_NET_ACTIVE_WINDOW", xlib.False);
-    net_supported = xlib.XInternAtom(display.handle, "_NET_SUPPORTED", xlib.False);
-    net_wm_name = xlib.XInternAtom(display.handle, "_NET_WM_NAME", xlib.False);
-    net_wm_state = xlib.XInternAtom(display.handle, "_NET_WM_STATE", xlib.False);
-    net_wm_check = xlib.XInternAtom(display.handle, "_NET_SUPPORTING_WM_CHECK", xlib.False);
-    net_wm_state_fullscreen = xlib.XInternAtom(display.handle, "_NET_WM_STATE_FULLSCREEN", xlib.False);
-    net_wm_window_type = xlib.XInternAtom(display.handle, "_NET_WM_WINDOW_TYPE", xlib.False);
-    net_wm_window_type_dialog = xlib.XInternAtom(display.handle, "_NET_WM_WINDOW_TYPE_DIALOG", xlib.False);
-    net_client_list = xlib.XInternAtom(display.handle, "_NET_CLIENT_LIST", xlib.False);
-
-    const utf8_string = xlib.XInternAtom(display.handle, "UTF8_STRING", xlib.False);
+    var names: [atom_targets.len][*c]u8 = undefined;
+    for (atom_targets, 0..) |entry, index| {
+        names[index] = @constCast(entry.name);
+    }
+    var atoms = [_]xlib.Atom{0} ** atom_targets.len;
+    if (xlib.XInternAtoms(display.handle, &names, names.len, xlib.False, &atoms) == 0) {
+        log.err(.core, "failed to intern atoms", .{});
+    }
+    for (atom_targets, atoms) |entry, atom| {
+        entry.target.* = atom;
+    }
 
     wm_check_window = xlib.XCreateSimpleWindow(display.handle, display.root, 0, 0, 1, 1, 0, 0, 0);
     _ = xlib.XChangeProperty(display.handle, wm_check_window, net_wm_check, xlib.XA_WINDOW, 32, xlib.PropModeReplace, @ptrCast(&wm_check_window), 1);
     _ = xlib.XChangeProperty(display.handle, wm_check_window, net_wm_name, utf8_string, 8, xlib.PropModeReplace, "goonwm", 6);
     _ = xlib.XChangeProperty(display.handle, display.root, net_wm_check, xlib.XA_WINDOW, 32, xlib.PropModeReplace, @ptrCast(&wm_check_window), 1);
 
-    var net_atoms = [_]xlib.Atom{ net_supported, net_wm_name, net_wm_state, net_wm_check, net_wm_state_fullscreen, net_active_window, net_wm_window_type, net_wm_window_type_dialog, net_client_list };
+    var net_atoms = [_]xlib.Atom{ net_supported, net_wm_name, net_wm_state, net_wm_check, net_wm_state_fullscreen, net_active_window, net_wm_window_type, net_wm_window_type_dialog, net_client_list, net_client_list_stacking };
     _ = xlib.XChangeProperty(display.handle, display.root, net_supported, xlib.XA_ATOM, 32, xlib.PropModeReplace, @ptrCast(&net_atoms), net_atoms.len);
 
-    _ = xlib.XDeleteProperty(display.handle, display.root, net_client_list);
+    client_list.init(memory.allocator(.core), display.handle, display.root, net_client_list, net_client_list_stacking);
+    properties.init(display.handle, net_wm_name);
 
-    std.debug.print("atoms initialized with EWMH support\n", .{});
+    log.info(.core, "atoms initialized with EWMH support", .{});
 }
 
 fn setup_cursors(display: *Display) void {
@@ -191,36 +309,33 @@ fn setup_cursors(display: *Display) void {
 
 fn setup_bars(allocator: std.mem.Allocator, display: *Display) void {
     var current_monitor = monitor_mod.monitors;
-    var last_bar: ?*bar_mod.Bar = null;
-
     while (current_monitor) |monitor| {
-        const bar = bar_mod.Bar.create(allocator, display.handle, display.screen, monitor, config.font);
-        if (bar) |created_bar| {
-            if (tiling.bar_height == 0) {
-                tiling.set_bar_height(created_bar.height);
-            }
+        if (create_bar(allocator, display, monitor)) |bar| {
+            bar_mod.append_bar(bar);
+        }
+        current_monitor = monitor.next;
+    }
+}
 
-            if (config.blocks.items.len > 0) {
-                for (config.blocks.items) |cfg_block| {
-                    const block = config_block_to_bar_block(cfg_block);
-                    created_bar.add_block(block);
-                }
-            } else {
-                created_bar.add_block(blocks_mod.Block.init_ram("", 5, 0x7aa2f7, true));
-                created_bar.add_block(blocks_mod.Block.init_static(" | ", 0x666666, false));
-                created_bar.add_block(blocks_mod.Block.init_datetime("", "%H:%M", 1, 0x0db9d7, true));
-            }
+fn create_bar(allocator: std.mem.Allocator, display: *Display, monitor: *Monitor) ?*bar_mod.Bar {
+    const created_bar = bar_mod.Bar.create(allocator, display.handle, display.screen, monitor, config.font) orelse return null;
+    if (tiling.bar_height == 0) {
+        tiling.set_bar_height(created_bar.height);
+    }
 
-            if (last_bar) |prev| {
-                prev.next = created_bar;
-            } else {
-                bar_mod.bars = created_bar;
-            }
-            last_bar = created_bar;
-            std.debug.print("bar created for monitor {d}\n", .{monitor.num});
+    if (config.blocks.items.len > 0) {
+        for (config.blocks.items) |cfg_block| {
+            const block = config_block_to_bar_block(cfg_block);
+            created_bar.add_block(block);
         }
-        current_monitor = monitor.next;
+    } else {
+        created_bar.add_block(blocks_mod.Block.init_ram("", 5, 0x7aa2f7, true));
+        created_bar.add_block(blocks_mod.Block.init_static(" | ", 0x666666, false));
+        created_bar.add_block(blocks_mod.Block.init_datetime("", "%H:%M", 1, 0x0db9d7, true));
     }
+
+    log.info(.bar, "bar created for monitor {d}", .{monitor.num});
+    return created_bar;
 }
 
 fn config_block_to_bar_block(cfg: config_mod.Block) blocks_mod.Block {
@@ -254,71 +369,66 @@ fn config_block_to_bar_block(cfg: config_mod.Block) blocks_mod.Block {
             cfg.color,
             cfg.underline,
         ),
+        .cpu_usage => blocks_mod.Block.init_cpu_usage(cfg.format, cfg.per_core, cfg.interval, cfg.color, cfg.underline),
+        .net_rate => blocks_mod.Block.init_net_rate(cfg.format, cfg.interface orelse "", cfg.interval, cfg.color, cfg.underline),
+        .file => blocks_mod.Block.init_file(cfg.format, cfg.path orelse "", cfg.color, cfg.underline),
     };
 }
 
-fn setup_monitors(display: *Display) void {
-    std.debug.print("checking xinerama...\n", .{});
+const max_screens = 16;
+
+const Screen_Area = struct {
+    x: i32,
+    y: i32,
+    width: i32,
+    height: i32,
+};
+
+fn query_screens(display: *Display, areas: *[max_screens]Screen_Area) usize {
+    var count: usize = 0;
     if (xlib.XineramaIsActive(display.handle) != 0) {
-        std.debug.print("xinerama is active!\n", .{});
         var screen_count: c_int = 0;
         const screens = xlib.XineramaQueryScreens(display.handle, &screen_count);
+        if (screens != null) {
+            defer _ = xlib.XFree(@ptrCast(screens));
+            const screen_total: usize = @intCast(@max(screen_count, 0));
+            for (screens[0..screen_total]) |screen| {
+                const area = Screen_Area{ .x = screen.x_org, .y = screen.y_org, .width = screen.width, .height = screen.height };
+                if (count == areas.len or has_area(areas[0..count], area)) continue;
+                areas[count] = area;
+                count += 1;
+            }
+        }
+    }
+    if (count == 0) {
+        areas[0] = .{ .x = 0, .y = 0, .width = display.screen_width(), .height = display.screen_height() };
+        count = 1;
+    }
+    return count;
+}
 
-        if (screen_count > 0 and screens != null) {
-            var prev_monitor: ?*Monitor = null;
-            var index: usize = 0;
-
-            while (index < @as(usize, @intCast(screen_count))) : (index += 1) {
-                const screen = screens[index];
-                const mon = monitor_mod.create() orelse continue;
-
-                mon.num = @intCast(index);
-                mon.mon_x = screen.x_org;
-                mon.mon_y = screen.y_org;
-                mon.mon_w = screen.width;
-                mon.mon_h = screen.height;
-                mon.win_x = screen.x_org;
-                mon.win_y = screen.y_org;
-                mon.win_w = screen.width;
-                mon.win_h = screen.height;
-                mon.lt[0] = &tiling.layout;
-                mon.lt[1] = &monocle.layout;
-                mon.lt[2] = &floating.layout;
-                mon.lt[3] = &scrolling.layout;
-                for (0..10) |i| {
-                    mon.pertag.ltidxs[i][0] = mon.lt[0];
-                    mon.pertag.ltidxs[i][1] = mon.lt[1];
-                    mon.pertag.ltidxs[i][2] = mon.lt[2];
-                    mon.pertag.ltidxs[i][3] = mon.lt[3];
-                }
-
-                if (prev_monitor) |prev| {
-                    prev.next = mon;
-                } else {
-                    monitor_mod.monitors = mon;
-                }
-                prev_monitor = mon;
+fn has_area(areas: []const Screen_Area, area: Screen_Area) bool {
+    for (areas) |existing| {
+        if (std.meta.eql(existing, area)) return true;
+    }
+    return false;
+}
 
-                std.debug.print("monitor {d}: {d}x{d} at ({d},{d})\n", .{ index, mon.mon_w, mon.mon_h, mon.mon_x, mon.mon_y });
-            }
+fn set_monitor_area(mon: *Monitor, area: Screen_Area) void {
+    mon.mon_x = area.x;
+    mon.mon_y = area.y;
+    mon.mon_w = area.width;
+    mon.mon_h = area.height;
+    mon.win_x = area.x;
+    mon.win_y = area.y;
+    mon.win_w = area.width;
+    mon.win_h = area.height;
+    mon.monocle_area = null;
+}
 
-            monitor_mod.selected_monitor = monitor_mod.monitors;
-            _ = xlib.XFree(@ptrCast(screens));
-            return;
-        }
-    } else {
-        std.debug.print("xinerama not active, using single monitor\n", .{});
-    }
-
-    const mon = monitor_mod.create() orelse return;
-    mon.mon_x = 0;
-    mon.mon_y = 0;
-    mon.mon_w = display.screen_width();
-    mon.mon_h = display.screen_height();
-    mon.win_x = 0;
-    mon.win_y = 0;
-    mon.win_w = display.screen_width();
-    mon.win_h = display.screen_height();
+fn init_monitor(mon: *Monitor, num: usize, area: Screen_Area) void {
+    mon.num = @intCast(num);
+    set_monitor_area(mon, area);
     mon.lt[0] = &tiling.layout;
     mon.lt[1] = &monocle.layout;
     mon.lt[2] = &floating.layout;
@@ -329,9 +439,189 @@ fn setup_monitors(display: *Display) void {
         mon.pertag.ltidxs[i][2] = mon.lt[2];
         mon.pertag.ltidxs[i][3] = mon.lt[3];
     }
-    monitor_mod.monitors = mon;
-    monitor_mod.selected_monitor = mon;
-    std.debug.print("monitor created: {d}x{d}\n", .{ mon.mon_w, mon.mon_h });
+}
+
+fn setup_monitors(display: *Display) void {
+    var areas: [max_screens]Screen_Area = undefined;
+    const count = query_screens(display, &areas);
+
+    var prev_monitor: ?*Monitor = null;
+    for (areas[0..count], 0..) |area, index| {
+        const mon = monitor_mod.create() orelse continue;
+        init_monitor(mon, index, area);
+        if (prev_monitor) |prev| {
+            prev.next = mon;
+        } else {
+            monitor_mod.monitors = mon;
+        }
+        prev_monitor = mon;
+        log.info(.monitor, "monitor {d}: {d}x{d} at ({d},{d})", .{ index, mon.mon_w, mon.mon_h, mon.mon_x, mon.mon_y });
+    }
+    monitor_mod.selected_monitor = monitor_mod.monitors;
+
+    var event_base: c_int = 0;
+    var error_base: c_int = 0;
+    if (xlib.XRRQueryExtension(display.handle, &event_base, &error_base) != 0) {
+        randr_event_base = event_base;
+        const mask = xlib.RRScreenChangeNotifyMask | xlib.RRCrtcChangeNotifyMask | xlib.RROutputChangeNotifyMask;
+        xlib.XRRSelectInput(display.handle, display.root, @intCast(mask));
+    } else {
+        log.info(.monitor, "randr unavailable, monitor hotplug disabled", .{});
+    }
+}
+
+fn is_randr_event(event: *xlib.XEvent) bool {
+    if (randr_event_base < 0) return false;
+    return event.type == randr_event_base + xlib.RRScreenChangeNotify or event.type == randr_event_base + xlib.RRNotify;
+}
+
+fn update_geometry(display: *Display) void {
+    geometry_dirty = false;
+    var timer = std.time.Timer.start() catch null;
+
+    var areas: [max_screens]Screen_Area = undefined;
+    const count = query_screens(display, &areas);
+    const bar_allocator = memory.allocator(.bar);
+    var changed = false;
+
+    var prev_monitor: ?*Monitor = null;
+    var current = monitor_mod.monitors;
+    for (areas[0..count], 0..) |area, index| {
+        if (current) |mon| {
+            if (mon.mon_x != area.x or mon.mon_y != area.y or mon.mon_w != area.width or mon.mon_h != area.height) {
+                const origin_x = mon.win_x;
+                const origin_y = mon.win_y;
+                set_monitor_area(mon, area);
+                if (bar_mod.monitor_to_bar(mon)) |bar| {
+                    bar.resize(display.handle, display.screen);
+                }
+                var client = mon.clients;
+                while (client) |refit| : (client = refit.next) {
+                    refit_client(display, refit, mon, origin_x, origin_y);
+                }
+                arrange(mon);
+                changed = true;
+                log.info(.monitor, "monitor {d} changed: {d}x{d} at ({d},{d})", .{ index, area.width, area.height, area.x, area.y });
+            }
+            prev_monitor = mon;
+            current = mon.next;
+            continue;
+        }
+
+        const mon = monitor_mod.create() orelse break;
+        init_monitor(mon, index, area);
+        if (prev_monitor) |prev| {
+            prev.next = mon;
+        } else {
+            monitor_mod.monitors = mon;
+        }
+        prev_monitor = mon;
+        if (create_bar(bar_allocator, display, mon)) |bar| {
+            bar_mod.append_bar(bar);
+        }
+        changed = true;
+        log.info(.monitor, "monitor {d} added: {d}x{d} at ({d},{d})", .{ index, area.width, area.height, area.x, area.y });
+    }
+
+    const target = monitor_mod.monitors orelse return;
+    if (prev_monitor) |last| {
+        var removed = last.next;
+        last.next = null;
+        while (removed) |mon| {
+            removed = mon.next;
+            remove_monitor(display, mon, target);
+            changed = true;
+        }
+    }
+
+    if (!changed) return;
+
+    if (monitor_mod.selected_monitor == null) {
+        monitor_mod.selected_monitor = target;
+    }
+    monitor_mod.invalidate_index();
+    tiling.set_screen_size(display.screen_width(), display.screen_height());
+    focus(display, null);
+    bar_mod.invalidate_bars();
+    ipc.publish(.monitor, "\"monitors\":{d}", .{count});
+
+    if (timer) |*t| {
+        const elapsed: f64 = @floatFromInt(t.read());
+        log.info(.monitor, "geometry updated in {d:.3}ms", .{elapsed / std.time.ns_per_ms});
+    }
+}
+
+const Fit = struct { x: i32, y: i32, width: i32, height: i32 };
+
+fn fit_floating(mon: *Monitor, border_width: i32, rect: Fit, origin_x: i32, origin_y: i32) Fit {
+    const border = 2 * border_width;
+    const width = @max(1, @min(rect.width, mon.win_w - border));
+    const height = @max(1, @min(rect.height, mon.win_h - border));
+    return .{
+        .x = mon.win_x + @max(0, @min(rect.x - origin_x, mon.win_w - width - border)),
+        .y = mon.win_y + @max(0, @min(rect.y - origin_y, mon.win_h - height - border)),
+        .width = width,
+        .height = height,
+    };
+}
+
+fn refit_client(display: *Display, client: *Client, mon: *Monitor, origin_x: i32, origin_y: i32) void {
+    const current = Fit{ .x = client.x, .y = client.y, .width = client.width, .height = client.height };
+    var saved = Fit{ .x = client.old_x, .y = client.old_y, .width = client.old_width, .height = client.old_height };
+    var fit = current;
+    if (client.is_fullscreen) {
+        fit = .{ .x = mon.mon_x, .y = mon.mon_y, .width = mon.mon_w, .height = mon.mon_h };
+        saved = fit_floating(mon, client.old_border_width, saved, origin_x, origin_y);
+    } else if (client.is_floating) {
+        fit = fit_floating(mon, client.border_width, current, origin_x, origin_y);
+    } else {
+        return;
+    }
+    if (std.meta.eql(fit, current)) return;
+
+    if (client_mod.is_visible(client)) {
+        tiling.resize_client(client, fit.x, fit.y, fit.width, fit.height);
+    } else {
+        client.x = fit.x;
+        client.y = fit.y;
+        client.width = fit.width;
+        client.height = fit.height;
+        _ = xlib.XResizeWindow(display.handle, client.window, @intCast(fit.width), @intCast(fit.height));
+    }
+    if (client.is_fullscreen) {
+        client.old_x = saved.x;
+        client.old_y = saved.y;
+        client.old_width = saved.width;
+        client.old_height = saved.height;
+    }
+}
+
+fn remove_monitor(display: *Display, mon: *Monitor, target: *Monitor) void {
+    log.info(.monitor, "monitor {d} removed, moving clients to monitor {d}", .{ mon.num, target.num });
+
+    while (mon.clients) |client| {
+        client_mod.detach(client);
+        client_mod.detach_stack(client);
+        client.monitor = target;
+        client_mod.attach(client);
+        client_mod.attach_stack(client);
+        refit_client(display, client, target, mon.win_x, mon.win_y);
+    }
+
+    if (bar_mod.monitor_to_bar(mon)) |bar| {
+        bar_mod.remove_bar(memory.allocator(.bar), display.handle, bar);
+    }
+    if (monitor_mod.selected_monitor == mon) {
+        monitor_mod.selected_monitor = target;
+    }
+    if (last_motion_monitor == mon) {
+        last_motion_monitor = null;
+    }
+    if (drag.monitor == mon) {
+        drag.monitor = target;
+    }
+    monitor_mod.destroy(mon);
+    arrange(target);
 }
 
 fn apply_config_values() void {
@@ -343,6 +633,8 @@ fn apply_config_values() void {
     gap_outer_h = config.gap_outer_h;
     gap_outer_v = config.gap_outer_v;
     tags = config.tags;
+    log.set_level_name(config.log_level);
+    log.open_file(config.log_file);
 }
 
 fn setup_default_keybinds() void {
@@ -389,20 +681,20 @@ fn grab_keybinds(display: *Display) void {
 
     _ = xlib.XUngrabKey(display.handle, xlib.AnyKey, xlib.AnyModifier, display.root);
 
-    for (config.keybinds.items) |keybind| {
-        const keycode = xlib.XKeysymToKeycode(display.handle, @intCast(keybind.keysym));
-        if (keycode != 0) {
-            for (modifiers) |modifier| {
-                _ = xlib.XGrabKey(
-                    display.handle,
-                    keycode,
-                    keybind.mod_mask | modifier,
-                    display.root,
-                    xlib.True,
-                    xlib.GrabModeAsync,
-                    xlib.GrabModeAsync,
-                );
-            }
+    keys.rebuild(config.keybinds.items);
+    var bindings = keys.bindings();
+    while (bindings.next()) |key| {
+        const binding = keys.unpack(key.*);
+        for (modifiers) |modifier| {
+            _ = xlib.XGrabKey(
+                display.handle,
+                binding.keycode,
+                binding.modifiers | modifier,
+                display.root,
+                xlib.True,
+                xlib.GrabModeAsync,
+                xlib.GrabModeAsync,
+            );
         }
     }
 
@@ -425,7 +717,7 @@ fn grab_keybinds(display: *Display) void {
         }
     }
 
-    std.debug.print("grabbed {d} keybinds from config\n", .{config.keybinds.items.len});
+    log.info(.core, "grabbed {d} keybinds from config", .{config.keybinds.items.len});
 }
 
 fn get_state(display: *Display, window: xlib.Window) c_long {
@@ -462,6 +754,43 @@ fn get_state(display: *Display, window: xlib.Window) c_long {
     return state;
 }
 
+const Scan_Property = enum { class, net_name, name, normal_hints, hints, window_type, net_state };
+
+const Property_Reply = [*c]xlib.c.xcb_get_property_reply_t;
+
+const Scan_Entry = struct {
+    window: xlib.Window,
+    attributes: xlib.c.xcb_get_window_attributes_cookie_t,
+    geometry: xlib.c.xcb_get_geometry_cookie_t,
+    transient: xlib.c.xcb_get_property_cookie_t,
+    state: xlib.c.xcb_get_property_cookie_t,
+    properties: std.EnumArray(Scan_Property, xlib.c.xcb_get_property_cookie_t),
+    replies: std.EnumArray(Scan_Property, Property_Reply) = .initFill(null),
+    window_attrs: xlib.XWindowAttributes = undefined,
+    transient_for: xlib.Window = 0,
+    is_transient: bool = false,
+    manageable: bool = false,
+};
+
+const Property_Request = struct {
+    atom: xlib.Atom,
+    property_type: xlib.Atom,
+    length: u32,
+};
+
+fn scan_property_request(connection: ?*xlib.c.xcb_connection_t, window: xlib.c.xcb_window_t, property: Scan_Property) xlib.c.xcb_get_property_cookie_t {
+    const request: Property_Request = switch (property) {
+        .class => .{ .atom = xlib.XA_WM_CLASS, .property_type = xlib.XA_STRING, .length = 256 },
+        .net_name => .{ .atom = net_wm_name, .property_type = xlib.AnyPropertyType, .length = 64 },
+        .name => .{ .atom = xlib.XA_WM_NAME, .property_type = xlib.AnyPropertyType, .length = 64 },
+        .normal_hints => .{ .atom = xlib.XA_WM_NORMAL_HINTS, .property_type = xlib.XA_WM_SIZE_HINTS, .length = 18 },
+        .hints => .{ .atom = xlib.XA_WM_HINTS, .property_type = xlib.XA_WM_HINTS, .length = 9 },
+        .window_type => .{ .atom = net_wm_window_type, .property_type = xlib.XA_ATOM, .length = 1 },
+        .net_state => .{ .atom = net_wm_state, .property_type = xlib.XA_ATOM, .length = 1 },
+    };
+    return xlib.c.xcb_get_property(connection, 0, window, @intCast(request.atom), @intCast(request.property_type), 0, request.length);
+}
+
 fn scan_existing_windows(display: *Display) void {
     var root_return: xlib.Window = undefined;
     var parent_return: xlib.Window = undefined;
@@ -471,77 +800,551 @@ fn scan_existing_windows(display: *Display) void {
     if (xlib.XQueryTree(display.handle, display.root, &root_return, &parent_return, &children, &num_children) == 0) {
         return;
     }
-
-    var index: c_uint = 0;
-    while (index < num_children) : (index += 1) {
-        var window_attrs: xlib.XWindowAttributes = undefined;
-        if (xlib.XGetWindowAttributes(display.handle, children[index], &window_attrs) == 0) {
-            continue;
-        }
-        if (window_attrs.override_redirect != 0) {
-            continue;
-        }
-        var trans: xlib.Window = 0;
-        if (xlib.XGetTransientForHint(display.handle, children[index], &trans) != 0) {
-            continue;
+    defer {
+        if (children != null) {
+            _ = xlib.XFree(@ptrCast(children));
         }
-        if (window_attrs.map_state == IsViewable or get_state(display, children[index]) == IconicState) {
-            manage(display, children[index], &window_attrs);
+    }
+    if (num_children == 0) return;
+
+    const allocator = gpa.allocator();
+    const entries = allocator.alloc(Scan_Entry, num_children) catch return;
+    defer allocator.free(entries);
+
+    const connection = xlib.c.XGetXCBConnection(display.handle);
+    _ = xlib.c.XFlush(display.handle);
+
+    for (entries, children[0..num_children]) |*entry, window| {
+        const xcb_window: xlib.c.xcb_window_t = @intCast(window);
+        entry.* = .{
+            .window = window,
+            .attributes = xlib.c.xcb_get_window_attributes(connection, xcb_window),
+            .geometry = xlib.c.xcb_get_geometry(connection, xcb_window),
+            .transient = xlib.c.xcb_get_property(connection, 0, xcb_window, xlib.XA_WM_TRANSIENT_FOR, xlib.XA_WINDOW, 0, 1),
+            .state = xlib.c.xcb_get_property(connection, 0, xcb_window, @intCast(wm_state), @intCast(wm_state), 0, 2),
+            .properties = undefined,
+        };
+        for (std.enums.values(Scan_Property)) |property| {
+            entry.properties.set(property, scan_property_request(connection, xcb_window, property));
         }
     }
 
-    index = 0;
-    while (index < num_children) : (index += 1) {
-        var window_attrs: xlib.XWindowAttributes = undefined;
-        if (xlib.XGetWindowAttributes(display.handle, children[index], &window_attrs) == 0) {
-            continue;
+    for (entries) |*entry| {
+        collect_scan_entry(connection, entry);
+    }
+    defer for (entries) |*entry| {
+        for (&entry.replies.values) |reply| std.c.free(reply);
+    };
+
+    scanning = true;
+    for (entries) |*entry| {
+        if (entry.manageable and !entry.is_transient) {
+            manage(display, entry.window, &entry.window_attrs, entry);
         }
-        var trans: xlib.Window = 0;
-        if (xlib.XGetTransientForHint(display.handle, children[index], &trans) != 0) {
-            if (window_attrs.map_state == IsViewable or get_state(display, children[index]) == IconicState) {
-                manage(display, children[index], &window_attrs);
-            }
+    }
+    for (entries) |*entry| {
+        if (entry.manageable and entry.is_transient) {
+            manage(display, entry.window, &entry.window_attrs, entry);
         }
     }
+    scanning = false;
+}
 
-    if (children != null) {
-        _ = xlib.XFree(@ptrCast(children));
+fn collect_scan_entry(connection: ?*xlib.c.xcb_connection_t, entry: *Scan_Entry) void {
+    const attributes = xlib.xcb_reply(xlib.c.xcb_get_window_attributes_reply_t, connection, entry.attributes.sequence);
+    defer std.c.free(attributes);
+    const geometry = xlib.xcb_reply(xlib.c.xcb_get_geometry_reply_t, connection, entry.geometry.sequence);
+    defer std.c.free(geometry);
+    const transient = xlib.xcb_reply(xlib.c.xcb_get_property_reply_t, connection, entry.transient.sequence);
+    defer std.c.free(transient);
+    const state = xlib.xcb_reply(xlib.c.xcb_get_property_reply_t, connection, entry.state.sequence);
+    defer std.c.free(state);
+    for (std.enums.values(Scan_Property)) |property| {
+        entry.replies.set(property, xlib.xcb_reply(xlib.c.xcb_get_property_reply_t, connection, entry.properties.get(property).sequence));
     }
+
+    if (attributes == null or geometry == null) return;
+    if (attributes.*.override_redirect != 0) return;
+
+    if (transient != null and transient.*.type == xlib.XA_WINDOW and xlib.c.xcb_get_property_value_length(transient) >= 4) {
+        const value: *align(1) const u32 = @ptrCast(xlib.c.xcb_get_property_value(transient));
+        entry.transient_for = value.*;
+        entry.is_transient = true;
+    }
+
+    var iconic = false;
+    if (state != null and xlib.c.xcb_get_property_value_length(state) >= 4) {
+        const value: *align(1) const u32 = @ptrCast(xlib.c.xcb_get_property_value(state));
+        iconic = value.* == IconicState;
+    }
+
+    if (attributes.*.map_state != IsViewable and !iconic) return;
+
+    entry.window_attrs = std.mem.zeroes(xlib.XWindowAttributes);
+    entry.window_attrs.x = geometry.*.x;
+    entry.window_attrs.y = geometry.*.y;
+    entry.window_attrs.width = geometry.*.width;
+    entry.window_attrs.height = geometry.*.height;
+    entry.window_attrs.border_width = geometry.*.border_width;
+    entry.window_attrs.map_state = attributes.*.map_state;
+    entry.manageable = true;
+}
+
+fn scanned_value(entry: *const Scan_Entry, property: Scan_Property, format: u8, expected_type: xlib.Atom) ?[]const u8 {
+    const reply = entry.replies.get(property);
+    if (reply == null or reply.*.bytes_after != 0) return null;
+    if (reply.*.type == xlib.None) return "";
+    if (reply.*.type != expected_type or reply.*.format != format) return null;
+    const data: [*]const u8 = @ptrCast(xlib.c.xcb_get_property_value(reply));
+    return data[0..@intCast(xlib.c.xcb_get_property_value_length(reply))];
+}
+
+fn scanned_atom(entry: *const Scan_Entry, property: Scan_Property) ?xlib.Atom {
+    const value = scanned_value(entry, property, 32, xlib.XA_ATOM) orelse return null;
+    const atoms = std.mem.bytesAsSlice(u32, value);
+    return if (atoms.len > 0) atoms[0] else 0;
+}
+
+fn seed_scanned_names(client: *Client, entry: *const Scan_Entry) void {
+    if (scanned_value(entry, .class, 8, xlib.XA_STRING)) |value| {
+        properties.seed_class(client, value);
+    }
+    const net_name = scanned_value(entry, .net_name, 8, utf8_string) orelse return;
+    if (net_name.len > 0) {
+        properties.seed_title(client, net_name);
+    } else if (scanned_value(entry, .name, 8, xlib.XA_STRING)) |name| {
+        properties.seed_title(client, name);
+    }
+}
+
+fn apply_scanned_hints(display: *Display, client: *Client, entry: *const Scan_Entry) void {
+    const state = scanned_atom(entry, .net_state);
+    const window_type = scanned_atom(entry, .window_type);
+    if (state != null and window_type != null) {
+        apply_window_type(display, client, state.?, window_type.?);
+    } else {
+        update_window_type(display, client);
+    }
+
+    if (scanned_value(entry, .normal_hints, 32, xlib.XA_WM_SIZE_HINTS)) |value| {
+        properties.seed_size_hints(client, std.mem.bytesAsSlice(u32, value));
+    }
+    properties.ensure_size_hints(client);
+
+    const hints = scanned_value(entry, .hints, 32, xlib.XA_WM_HINTS) orelse {
+        update_wm_hints(display, client);
+        return;
+    };
+    const words = std.mem.bytesAsSlice(u32, hints);
+    if (words.len < 8) return;
+    const flags: c_long = words[0];
+    client_mod.set_urgent(client, (flags & xlib.XUrgencyHint) != 0);
+    client.never_focus = (flags & xlib.InputHint) != 0 and words[1] == 0;
 }
 
 fn run_event_loop(display: *Display) void {
     const x11_fd = xlib.XConnectionNumber(display.handle);
-    var fds = [_]std.posix.pollfd{
-        .{ .fd = x11_fd, .events = std.posix.POLL.IN, .revents = 0 },
-    };
+    const fixed_fds = 5;
+    var fds: [fixed_fds + ipc.max_pollfds]std.posix.pollfd = undefined;
+    fds[0] = .{ .fd = x11_fd, .events = std.posix.POLL.IN, .revents = 0 };
+    for (fds[1..fixed_fds]) |*pollfd| {
+        pollfd.* = .{ .fd = -1, .events = std.posix.POLL.IN, .revents = 0 };
+    }
 
     _ = xlib.XSync(display.handle, xlib.False);
 
     while (running) {
+        var handled: usize = 0;
         while (xlib.XPending(display.handle) > 0) {
             var event = display.next_event();
+            const span = trace.begin();
+            record_event(&event, span.start_ns);
             handle_event(display, &event);
+            trace.end_event(events.get_event_type(&event), span);
+            handled += 1;
+        }
+        if (handled > 0) {
+            record_batch_end();
         }
 
+        if (geometry_dirty) {
+            update_geometry(display);
+        }
+        flush_property_updates(display);
+        tick_drag();
         tick_animations();
 
         var current_bar = bar_mod.bars;
         while (current_bar) |bar| {
             bar.update_blocks();
-            bar.draw(display.handle, &tags);
+            if (bar.needs_redraw) {
+                const span = trace.begin();
+                bar.draw(display.handle, &tags);
+                trace.end_bar_draw(span);
+            }
             current_bar = bar.next;
         }
 
-        const poll_timeout: i32 = if (scroll_animation.is_active()) 16 else 1000;
-        _ = std.posix.poll(&fds, poll_timeout) catch 0;
+        _ = xlib.XFlush(display.handle);
+        trace.flushed();
+        log.flush();
+        if (trace.take_dump_request()) {
+            trace.dump_to_stderr();
+            dump_memory_to_stderr();
+        }
+
+        fds[1].fd = pulseaudio.get_event_fd() orelse -1;
+        fds[2].fd = blocks_mod.uevent.get_fd() orelse -1;
+        fds[3].fd = blocks_mod.file.get_fd() orelse -1;
+        fds[4].fd = spawn.get_fd() orelse -1;
+        const ipc_fds = ipc.poll_fds(fds[fixed_fds..]);
+
+        const poll_timeout: i32 = if (scroll_animation.is_active() or drag.has_motion) 16 else 1000;
+        _ = std.posix.poll(fds[0 .. fixed_fds + ipc_fds], poll_timeout) catch 0;
+        trace.wake();
+
+        if ((fds[1].revents & std.posix.POLL.IN) != 0 and pulseaudio.consume_event()) {
+            bar_mod.refresh_blocks(.pulseaudio);
+        }
+        if ((fds[2].revents & std.posix.POLL.IN) != 0) {
+            handle_uevents();
+        }
+        if ((fds[3].revents & std.posix.POLL.IN) != 0) {
+            handle_file_events();
+        }
+        if ((fds[4].revents & std.posix.POLL.IN) != 0) {
+            spawn.reap();
+        }
+        ipc.handle_poll(fds[fixed_fds .. fixed_fds + ipc_fds]);
+    }
+}
+
+fn run_ipc_action(action: config_mod.Action, int_arg: i32, str_arg: ?[]const u8) void {
+    const display = display_global orelse return;
+    execute_action(display, action, int_arg, str_arg);
+}
+
+fn write_ipc_query(what: []const u8, writer: *std.Io.Writer) std.Io.Writer.Error!bool {
+    if (std.mem.eql(u8, what, "monitors")) {
+        try write_monitors_json(writer);
+    } else if (std.mem.eql(u8, what, "tags")) {
+        try write_tags_json(writer);
+    } else if (std.mem.eql(u8, what, "clients")) {
+        try write_clients_json(writer);
+    } else if (std.mem.eql(u8, what, "layout")) {
+        const monitor = monitor_mod.selected_monitor orelse {
+            try writer.writeAll("null");
+            return true;
+        };
+        try write_layout_json(writer, monitor);
+    } else if (std.mem.eql(u8, what, "memory")) {
+        const report = collect_memory_report();
+        try memory.write_json(&report, writer);
+    } else if (std.mem.eql(u8, what, "bar")) {
+        try trace.write_bar_json(writer);
+    } else if (std.mem.eql(u8, what, "trace")) {
+        var buffer: [16 * 1024]u8 = undefined;
+        var table = std.Io.Writer.fixed(&buffer);
+        trace.dump(&table) catch {};
+        try writer.print("{{\"trace\":{f}}}", .{ipc.json(table.buffered())});
+    } else {
+        return false;
+    }
+    return true;
+}
+
+fn collect_memory_report() memory.Report {
+    var report = memory.Report{};
+    client_mod.fill_memory_report(&report);
+    monitor_mod.fill_memory_report(&report);
+    bar_mod.fill_memory_report(&report);
+    report.goon_bytes = goon.memory_usage();
+    return report;
+}
+
+fn dump_memory_to_stderr() void {
+    var buffer: [4096]u8 = undefined;
+    var stderr_writer = std.fs.File.stderr().writer(&buffer);
+    const writer = &stderr_writer.interface;
+    const report = collect_memory_report();
+    writer.print("goonwm memory\n", .{}) catch return;
+    memory.write_text(&report, writer) catch return;
+    writer.flush() catch return;
+}
+
+fn layout_symbol(monitor: *Monitor) []const u8 {
+    const layout = monitor.lt[monitor.sel_lt] orelse return "";
+    return layout.symbol;
+}
+
+fn write_layout_json(writer: *std.Io.Writer, monitor: *Monitor) std.Io.Writer.Error!void {
+    try writer.print("{{\"monitor\":{d},\"index\":{d},\"symbol\":{f},\"nmaster\":{d},\"mfact\":{d:.2},\"scroll_offset\":{d}}}", .{
+        monitor.num,
+        monitor.sel_lt,
+        ipc.json(layout_symbol(monitor)),
+        monitor.nmaster,
+        monitor.mfact,
+        monitor.scroll_offset,
+    });
+}
+
+fn write_monitors_json(writer: *std.Io.Writer) std.Io.Writer.Error!void {
+    try writer.writeByte('[');
+    var current = monitor_mod.monitors;
+    while (current) |monitor| {
+        if (monitor != monitor_mod.monitors) try writer.writeByte(',');
+        try writer.print("{{\"num\":{d},\"x\":{d},\"y\":{d},\"width\":{d},\"height\":{d},\"window_area\":{{\"x\":{d},\"y\":{d},\"width\":{d},\"height\":{d}}},\"selected\":{},\"tags\":{d},\"layout\":{f},\"focused\":{d}}}", .{
+            monitor.num,
+            monitor.mon_x,
+            monitor.mon_y,
+            monitor.mon_w,
+            monitor.mon_h,
+            monitor.win_x,
+            monitor.win_y,
+            monitor.win_w,
+            monitor.win_h,
+            monitor == monitor_mod.selected_monitor,
+            monitor.tagset[monitor.sel_tags],
+            ipc.json(layout_symbol(monitor)),
+            if (monitor.sel) |client| client.window else 0,
+        });
+        current = monitor.next;
+    }
+    try writer.writeByte(']');
+}
+
+fn write_tags_json(writer: *std.Io.Writer) std.Io.Writer.Error!void {
+    try writer.writeByte('[');
+    var current = monitor_mod.monitors;
+    while (current) |monitor| {
+        if (monitor != monitor_mod.monitors) try writer.writeByte(',');
+        try writer.print("{{\"monitor\":{d},\"tags\":[", .{monitor.num});
+        for (tags, 0..) |name, index| {
+            const mask = @as(u32, 1) << @intCast(index);
+            if (index > 0) try writer.writeByte(',');
+            try writer.print("{{\"index\":{d},\"name\":{f},\"selected\":{},\"occupied\":{},\"urgent\":{}}}", .{
+                index,
+                ipc.json(name),
+                (monitor.tagset[monitor.sel_tags] & mask) != 0,
+                (monitor.occupied_mask & mask) != 0,
+                (monitor.urgent_mask & mask) != 0,
+            });
+        }
+        try writer.writeAll("]}");
+        current = monitor.next;
+    }
+    try writer.writeByte(']');
+}
+
+fn write_clients_json(writer: *std.Io.Writer) std.Io.Writer.Error!void {
+    try writer.writeByte('[');
+    var first = true;
+    var current_monitor = monitor_mod.monitors;
+    while (current_monitor) |monitor| {
+        var current = monitor.clients;
+        while (current) |client| {
+            if (!first) try writer.writeByte(',');
+            first = false;
+            try writer.print("{{\"window\":{d},\"monitor\":{d},\"tags\":{d},\"title\":{f},\"class\":{f},\"instance\":{f},\"x\":{d},\"y\":{d},\"width\":{d},\"height\":{d},\"floating\":{},\"fullscreen\":{},\"urgent\":{},\"focused\":{}}}", .{
+                client.window,
+                monitor.num,
+                client.tags,
+                ipc.json(properties.get_title(client)),
+                ipc.json(properties.get_class(client)),
+                ipc.json(properties.get_instance(client)),
+                client.x,
+                client.y,
+                client.width,
+                client.height,
+                client.is_floating,
+                client.is_fullscreen,
+                client.is_urgent,
+                monitor.sel == client,
+            });
+            current = client.next;
+        }
+        current_monitor = monitor.next;
+    }
+    try writer.writeByte(']');
+}
+
+fn publish_tags(monitor: *Monitor) void {
+    ipc.publish(.tag, "\"monitor\":{d},\"selected\":{d},\"occupied\":{d},\"urgent\":{d}", .{
+        monitor.num,
+        monitor.tagset[monitor.sel_tags],
+        monitor.occupied_mask,
+        monitor.urgent_mask,
+    });
+}
+
+fn publish_layout(monitor: *Monitor) void {
+    ipc.publish(.layout, "\"monitor\":{d},\"index\":{d},\"symbol\":{f}", .{
+        monitor.num,
+        monitor.sel_lt,
+        ipc.json(layout_symbol(monitor)),
+    });
+}
+
+fn handle_file_events() void {
+    var reader = blocks_mod.file.Event_Reader{};
+    while (reader.next()) |event| {
+        bar_mod.refresh_file_blocks(event.watch, event.mask);
+    }
+}
+
+fn handle_uevents() void {
+    var buffer: [4096]u8 = undefined;
+    var power_supply_changed = false;
+    while (blocks_mod.uevent.next_event(&buffer)) |uevent| {
+        if (blocks_mod.uevent.is_power_supply(uevent)) {
+            power_supply_changed = true;
+        }
+    }
+    if (power_supply_changed) {
+        bar_mod.refresh_blocks(.battery);
+    }
+}
+
+fn record_event(event: *const xlib.XEvent, time_ns: u64) void {
+    if (!event_trace.recording()) return;
+    event_trace.record(event, time_ns) catch |err| {
+        log.warn(.core, "event recording stopped: {}", .{err});
+        event_trace.finish();
+    };
+}
+
+fn record_batch_end() void {
+    if (!event_trace.recording()) return;
+    event_trace.end_batch(trace.now()) catch |err| {
+        log.warn(.core, "event recording stopped: {}", .{err});
+        event_trace.finish();
+    };
+}
+
+fn run_replay(display: *Display, path: []const u8) void {
+    const allocator = memory.allocator(.core);
+    const data = std.fs.cwd().readFileAlloc(allocator, path, 1 << 30) catch |err| {
+        log.err(.core, "failed to read trace {s}: {}", .{ path, err });
+        return;
+    };
+    defer allocator.free(data);
+
+    var reader = event_trace.Reader.init(data) catch {
+        log.err(.core, "{s} is not an event trace", .{path});
+        return;
+    };
+
+    _ = xlib.XSync(display.handle, xlib.False);
+    stub_server.reset_counts();
+    const first_request = xlib.XNextRequest(display.handle);
+    const first_round_trips = xlib.round_trips;
+    var event_count: u64 = 0;
+    var batch_count: u64 = 0;
+
+    const cpu_start = trace.cpu_now();
+    while (true) {
+        const entry = reader.next() catch {
+            log.err(.core, "trace {s} is truncated", .{path});
+            break;
+        } orelse break;
+
+        switch (entry) {
+            .event => |recorded| {
+                var event = recorded;
+                event.xany.display = display.handle;
+                const span = trace.begin();
+                handle_event(display, &event);
+                trace.end_event(events.get_event_type(&event), span);
+                event_count += 1;
+            },
+            .batch_end => {
+                if (geometry_dirty) {
+                    update_geometry(display);
+                }
+                flush_property_updates(display);
+                trace.flushed();
+                batch_count += 1;
+            },
+        }
     }
+    flush_property_updates(display);
+    const cpu_ns = trace.cpu_now() - cpu_start;
+    const requests = xlib.XNextRequest(display.handle) -% first_request;
+    const round_trips = xlib.round_trips - first_round_trips;
+    _ = xlib.XSync(display.handle, xlib.False);
+
+    var buffer: [4096]u8 = undefined;
+    var stdout_writer = std.fs.File.stdout().writer(&buffer);
+    const out = &stdout_writer.interface;
+    write_replay_report(out, .{
+        .name = std.fs.path.basename(path),
+        .events = event_count,
+        .batches = batch_count,
+        .span_us = reader.time_us,
+        .cpu_ns = cpu_ns,
+        .requests = requests,
+        .round_trips = round_trips,
+    }) catch {};
+    out.flush() catch {};
+}
+
+const Replay_Summary = struct {
+    name: []const u8,
+    events: u64,
+    batches: u64,
+    span_us: u64,
+    cpu_ns: u64,
+    requests: u64,
+    round_trips: u64,
+};
+
+fn write_replay_report(out: *std.Io.Writer, summary: Replay_Summary) !void {
+    const events_f: f64 = @floatFromInt(@max(summary.events, 1));
+    const cpu_ms = @as(f64, @floatFromInt(summary.cpu_ns)) / std.time.ns_per_ms;
+
+    try out.print("replay {s}: {d} events in {d} batches, recorded over {d}ms\n", .{ summary.name, summary.events, summary.batches, summary.span_us / std.time.us_per_ms });
+    try out.print("handler cpu   {d:.3}ms total, {d:.0}ns/event\n", .{ cpu_ms, @as(f64, @floatFromInt(summary.cpu_ns)) / events_f });
+    try out.print("requests      {d} total, {d:.2}/event\n", .{ summary.requests, @as(f64, @floatFromInt(summary.requests)) / events_f });
+    try out.print("round trips   {d} total, {d:.3}/event\n\n", .{ summary.round_trips, @as(f64, @floatFromInt(summary.round_trips)) / events_f });
+    try trace.dump(out);
+
+    const Opcode_Count = struct { opcode: u8, count: u64 };
+    var counts: [256]Opcode_Count = undefined;
+    var used: usize = 0;
+    for (0..256) |opcode| {
+        const count = stub_server.count(@intCast(opcode));
+        if (count == 0) continue;
+        counts[used] = .{ .opcode = @intCast(opcode), .count = count };
+        used += 1;
+    }
+    std.mem.sort(Opcode_Count, counts[0..used], {}, struct {
+        fn more(_: void, a: Opcode_Count, b: Opcode_Count) bool {
+            return a.count > b.count;
+        }
+    }.more);
+
+    try out.print("\n{s:<24} {s:>8} {s:>10}\n", .{ "request", "opcode", "count" });
+    for (counts[0..@min(used, 12)]) |entry| {
+        try out.print("{s:<24} {d:>8} {d:>10}\n", .{ stub_server.opcode_name(entry.opcode), entry.opcode, entry.count });
+    }
+    try out.writeByte('\n');
 }
 
 fn handle_event(display: *Display, event: *xlib.XEvent) void {
     const event_type = events.get_event_type(event);
 
     if (event_type == .button_press) {
-        std.debug.print("EVENT: button_press received type={d}\n", .{event.type});
+        log.debug(.event, "EVENT: button_press received type={d}", .{event.type});
+    }
+
+    if (is_randr_event(event)) {
+        _ = xlib.XRRUpdateConfiguration(event);
+        geometry_dirty = true;
+        return;
+    }
+
+    if (handle_drag_event(event, event_type)) {
+        return;
     }
 
     switch (event_type) {
@@ -557,12 +1360,18 @@ fn handle_event(display: *Display, event: *xlib.XEvent) void {
         .button_press => handle_button_press(display, &event.xbutton),
         .expose => handle_expose(display, &event.xexpose),
         .property_notify => handle_property_notify(display, &event.xproperty),
+        .mapping_notify => handle_mapping_notify(display, &event.xmapping),
+        .configure_notify => {
+            if (event.xconfigure.window == display.root) {
+                geometry_dirty = true;
+            }
+        },
         else => {},
     }
 }
 
 fn handle_map_request(display: *Display, event: *xlib.XMapRequestEvent) void {
-    std.debug.print("map_request: window=0x{x}\n", .{event.window});
+    log.debug(.event, "map_request: window=0x{x}", .{event.window});
 
     var window_attributes: xlib.XWindowAttributes = undefined;
     if (xlib.XGetWindowAttributes(display.handle, event.window, &window_attributes) == 0) {
@@ -575,10 +1384,10 @@ fn handle_map_request(display: *Display, event: *xlib.XMapRequestEvent) void {
         return;
     }
 
-    manage(display, event.window, &window_attributes);
+    manage(display, event.window, &window_attributes, null);
 }
 
-fn manage(display: *Display, win: xlib.Window, window_attrs: *xlib.XWindowAttributes) void {
+fn manage(display: *Display, win: xlib.Window, window_attrs: *xlib.XWindowAttributes, scanned: ?*const Scan_Entry) void {
     const client = client_mod.create(win) orelse return;
     var trans: xlib.Window = 0;
 
@@ -592,10 +1401,15 @@ fn manage(display: *Display, win: xlib.Window, window_attrs: *xlib.XWindowAttrib
     client.old_height = window_attrs.height;
     client.old_border_width = window_attrs.border_width;
     client.border_width = border_width;
+    client.dirty = properties.title | properties.size_hints | properties.class;
 
-    update_title(display, client);
-
-    if (xlib.XGetTransientForHint(display.handle, win, &trans) != 0) {
+    if (scanned) |entry| {
+        trans = entry.transient_for;
+        seed_scanned_names(client, entry);
+    } else {
+        _ = xlib.XGetTransientForHint(display.handle, win, &trans);
+    }
+    if (trans != 0) {
         if (client_mod.window_to_client(trans)) |transient_client| {
             client.monitor = transient_client.monitor;
             client.tags = transient_client.tags;
@@ -604,7 +1418,7 @@ fn manage(display: *Display, win: xlib.Window, window_attrs: *xlib.XWindowAttrib
 
     if (client.monitor == null) {
         client.monitor = monitor_mod.selected_monitor;
-        apply_rules(display, client);
+        apply_rules(client);
     }
 
     const monitor = client.monitor orelse return;
@@ -622,9 +1436,13 @@ fn manage(display: *Display, win: xlib.Window, window_attrs: *xlib.XWindowAttrib
     _ = xlib.XSetWindowBorder(display.handle, win, border_color_unfocused);
     tiling.send_configure(client);
 
-    update_window_type(display, client);
-    update_size_hints(display, client);
-    update_wm_hints(display, client);
+    if (scanned) |entry| {
+        apply_scanned_hints(display, client, entry);
+    } else {
+        update_window_type(display, client);
+        properties.ensure_size_hints(client);
+        update_wm_hints(display, client);
+    }
 
     _ = xlib.XSelectInput(
         display.handle,
@@ -644,7 +1462,7 @@ fn manage(display: *Display, win: xlib.Window, window_attrs: *xlib.XWindowAttrib
     client_mod.attach_aside(client);
     client_mod.attach_stack(client);
 
-    _ = xlib.XChangeProperty(display.handle, display.root, net_client_list, xlib.XA_WINDOW, 32, xlib.PropModeAppend, @ptrCast(&client.window), 1);
+    client_list.add(client.window);
     _ = xlib.XMoveResizeWindow(display.handle, client.window, client.x + 2 * display.screen_width(), client.y, @intCast(client.width), @intCast(client.height));
     set_client_state(display, client, NormalState);
 
@@ -658,6 +1476,11 @@ fn manage(display: *Display, win: xlib.Window, window_attrs: *xlib.XWindowAttrib
         monitor.scroll_offset = 0;
     }
 
+    if (scanning) {
+        _ = xlib.XMapWindow(display.handle, win);
+        return;
+    }
+
     arrange(monitor);
     _ = xlib.XMapWindow(display.handle, win);
     focus(display, null);
@@ -669,6 +1492,9 @@ fn handle_configure_request(display: *Display, event: *xlib.XConfigureRequestEve
     if (client) |managed_client| {
         if ((event.value_mask & xlib.c.CWBorderWidth) != 0) {
             managed_client.border_width = event.border_width;
+            if (managed_client.monitor) |monitor| {
+                monitor_mod.invalidate_tiled(monitor);
+            }
         } else if (managed_client.is_floating or (managed_client.monitor != null and managed_client.monitor.?.lt[managed_client.monitor.?.sel_lt] == null)) {
             const monitor = managed_client.monitor orelse return;
             if ((event.value_mask & xlib.c.CWX) != 0) {
@@ -719,18 +1545,33 @@ fn handle_configure_request(display: *Display, event: *xlib.XConfigureRequestEve
 }
 
 fn handle_key_press(display: *Display, event: *xlib.XKeyEvent) void {
-    const keysym = xlib.XKeycodeToKeysym(display.handle, @intCast(event.keycode), 0);
-    const clean_state = event.state & ~@as(c_uint, xlib.LockMask | xlib.Mod2Mask);
+    track_pointer(event.x_root, event.y_root);
+    const index = keys.lookup(@intCast(event.keycode), clean_mask(event.state)) orelse return;
+    execute_keybind(display, &config.keybinds.items[index]);
+}
 
-    for (config.keybinds.items) |keybind| {
-        if (keysym == keybind.keysym and clean_state == keybind.mod_mask) {
-            execute_action(display, keybind.action, keybind.int_arg, keybind.str_arg);
-            return;
-        }
+fn handle_mapping_notify(display: *Display, event: *xlib.XMappingEvent) void {
+    _ = xlib.XRefreshKeyboardMapping(event);
+    if (event.request == xlib.MappingKeyboard or event.request == xlib.MappingModifier) {
+        keys.refresh_keymap(display.handle);
+        grab_keybinds(display);
     }
 }
 
+fn execute_keybind(display: *Display, keybind: *const config_mod.Keybind) void {
+    if (keybind.command) |command| {
+        const span = trace.begin();
+        defer trace.end_action(keybind.action, span);
+        spawn.run(command);
+        return;
+    }
+    execute_action(display, keybind.action, keybind.int_arg, keybind.str_arg);
+}
+
 fn execute_action(display: *Display, action: config_mod.Action, int_arg: i32, str_arg: ?[]const u8) void {
+    const span = trace.begin();
+    defer trace.end_action(action, span);
+
     switch (action) {
         .spawn_terminal => spawn_terminal(),
         .spawn => {
@@ -740,7 +1581,7 @@ fn execute_action(display: *Display, action: config_mod.Action, int_arg: i32, st
         },
         .kill_client => kill_focused(display),
         .quit => {
-            std.debug.print("quit keybind pressed\n", .{});
+            log.info(.core, "quit keybind pressed", .{});
             running = false;
         },
         .reload_config => reload_config(display),
@@ -777,18 +1618,9 @@ fn execute_action(display: *Display, action: config_mod.Action, int_arg: i32, st
         },
         .focus_monitor => focusmon(display, int_arg),
         .send_to_monitor => sendmon(display, int_arg),
-        .volume_up => {
-            pulseaudio.adjust_volume(5);
-            bar_mod.force_pulseaudio_update();
-        },
-        .volume_down => {
-            pulseaudio.adjust_volume(-5);
-            bar_mod.force_pulseaudio_update();
-        },
-        .volume_mute => {
-            pulseaudio.toggle_mute();
-            bar_mod.force_pulseaudio_update();
-        },
+        .volume_up => pulseaudio.adjust_volume(5),
+        .volume_down => pulseaudio.adjust_volume(-5),
+        .volume_mute => pulseaudio.toggle_mute(),
         .scroll_left => {
             scroll_layout(-1);
         },
@@ -799,7 +1631,7 @@ fn execute_action(display: *Display, action: config_mod.Action, int_arg: i32, st
 }
 
 fn reload_config(display: *Display) void {
-    std.debug.print("reloading config...\n", .{});
+    log.info(.config, "reloading config...", .{});
 
     ungrab_keybinds(display);
 
@@ -817,20 +1649,22 @@ fn reload_config(display: *Display) void {
 
     if (loaded) {
         if (config_path_global) |path| {
-            std.debug.print("reloaded config from {s}\n", .{path});
+            log.info(.config, "reloaded config from {s}", .{path});
         } else {
-            std.debug.print("reloaded config from ~/.config/goonwm/config.goon\n", .{});
+            log.info(.config, "reloaded config from ~/.config/goonwm/config.goon", .{});
         }
         apply_config_values();
     } else {
-        std.debug.print("reload failed, restoring defaults\n", .{});
+        log.warn(.config, "reload failed, restoring defaults", .{});
         setup_default_keybinds();
     }
 
-    bar_mod.destroy_bars(gpa.allocator(), display.handle);
-    setup_bars(gpa.allocator(), display);
+    bar_mod.destroy_bars(memory.allocator(.bar), display.handle);
+    setup_bars(memory.allocator(.bar), display);
     rebuild_bar_blocks();
 
+    prepare_commands();
+    compile_rules();
     grab_keybinds(display);
 }
 
@@ -856,51 +1690,34 @@ fn ungrab_keybinds(display: *Display) void {
     _ = xlib.XUngrabKey(display.handle, xlib.AnyKey, xlib.AnyModifier, display.root);
 }
 
-fn spawn_child_setup() void {
-    _ = std.c.setsid();
-    if (display_global) |display| {
-        const display_fd = xlib.XConnectionNumber(display.handle);
-        std.posix.close(@intCast(display_fd));
-    }
-    const sigchld_handler = std.posix.Sigaction{
-        .handler = .{ .handler = std.posix.SIG.DFL },
-        .mask = std.mem.zeroes(std.posix.sigset_t),
-        .flags = 0,
+fn compile_rules() void {
+    if (rule_matcher) |*matcher| matcher.deinit();
+    rule_matcher = rules.Matcher.init(memory.allocator(.rules), config.rules.items) catch |err| blk: {
+        log.warn(.config, "failed to compile rules, falling back to a linear scan: {}", .{err});
+        break :blk null;
     };
-    std.posix.sigaction(std.posix.SIG.CHLD, &sigchld_handler, null);
 }
 
-fn spawn_command(cmd: []const u8) void {
-    const pid = std.posix.fork() catch return;
-    if (pid == 0) {
-        spawn_child_setup();
-        var cmd_buf: [1024]u8 = undefined;
-        if (cmd.len >= cmd_buf.len) {
-            std.posix.exit(1);
-        }
-        @memcpy(cmd_buf[0..cmd.len], cmd);
-        cmd_buf[cmd.len] = 0;
-        const argv = [_:null]?[*:0]const u8{ "sh", "-c", @ptrCast(&cmd_buf) };
-        _ = std.posix.execvpeZ("sh", &argv, std.c.environ) catch {};
-        std.posix.exit(1);
+fn prepare_commands() void {
+    spawn.release_prepared();
+    terminal_command = spawn.prepare(config.terminal);
+    for (config.keybinds.items) |*keybind| {
+        keybind.command = null;
+        if (keybind.action != .spawn) continue;
+        const text = keybind.str_arg orelse continue;
+        keybind.command = spawn.prepare(text);
     }
 }
 
+fn spawn_command(cmd: []const u8) void {
+    spawn.run_text(cmd);
+}
+
 fn spawn_terminal() void {
-    const pid = std.posix.fork() catch return;
-    if (pid == 0) {
-        spawn_child_setup();
-        var term_buf: [256]u8 = undefined;
-        const terminal = config.terminal;
-        if (terminal.len >= term_buf.len) {
-            std.posix.exit(1);
-        }
-        @memcpy(term_buf[0..terminal.len], terminal);
-        term_buf[terminal.len] = 0;
-        const term_ptr: [*:0]const u8 = @ptrCast(&term_buf);
-        const argv = [_:null]?[*:0]const u8{term_ptr};
-        _ = std.posix.execvpeZ(term_ptr, &argv, std.c.environ) catch {};
-        std.posix.exit(1);
+    if (terminal_command) |command| {
+        spawn.run(command);
+    } else {
+        spawn.run_text(config.terminal);
     }
 }
 
@@ -972,6 +1789,7 @@ fn toggle_view(display: *Display, tag_mask: u32) void {
     const new_tags = monitor.tagset[monitor.sel_tags] ^ tag_mask;
     if (new_tags != 0) {
         monitor.tagset[monitor.sel_tags] = new_tags;
+        monitor_mod.invalidate_tiled(monitor);
 
         if (new_tags == ~@as(u32, 0)) {
             monitor.pertag.prevtag = monitor.pertag.curtag;
@@ -994,6 +1812,7 @@ fn toggle_view(display: *Display, tag_mask: u32) void {
         focus_top_client(display, monitor);
         arrange(monitor);
         bar_mod.invalidate_bars();
+        publish_tags(monitor);
     }
 }
 
@@ -1002,10 +1821,11 @@ fn toggle_client_tag(display: *Display, tag_mask: u32) void {
     const client = monitor.sel orelse return;
     const new_tags = client.tags ^ tag_mask;
     if (new_tags != 0) {
-        client.tags = new_tags;
+        client_mod.set_tags(client, new_tags);
         focus_top_client(display, monitor);
         arrange(monitor);
         bar_mod.invalidate_bars();
+        publish_tags(monitor);
     }
 }
 
@@ -1028,7 +1848,7 @@ fn toggle_gaps() void {
 fn kill_focused(display: *Display) void {
     const selected = monitor_mod.selected_monitor orelse return;
     const client = selected.sel orelse return;
-    std.debug.print("killing window: 0x{x}\n", .{client.window});
+    log.info(.client, "killing window: 0x{x}", .{client.window});
 
     if (!send_event(display, client, wm_delete)) {
         _ = xlib.XGrabServer(display.handle);
@@ -1063,13 +1883,13 @@ fn set_fullscreen(display: *Display, client: *Client, fullscreen: bool) void {
         client.old_state = client.is_floating;
         client.old_border_width = client.border_width;
         client.border_width = 0;
-        client.is_floating = true;
+        client_mod.set_floating(client, true);
 
         _ = xlib.XSetWindowBorderWidth(display.handle, client.window, 0);
         tiling.resize_client(client, monitor.mon_x, monitor.mon_y, monitor.mon_w, monitor.mon_h);
         _ = xlib.XRaiseWindow(display.handle, client.window);
 
-        std.debug.print("fullscreen enabled: window=0x{x}\n", .{client.window});
+        log.info(.client, "fullscreen enabled: window=0x{x}", .{client.window});
     } else if (!fullscreen and client.is_fullscreen) {
         var no_atom: xlib.Atom = 0;
         _ = xlib.XChangeProperty(
@@ -1083,7 +1903,7 @@ fn set_fullscreen(display: *Display, client: *Client, fullscreen: bool) void {
             0,
         );
         client.is_fullscreen = false;
-        client.is_floating = client.old_state;
+        client_mod.set_floating(client, client.old_state);
         client.border_width = client.old_border_width;
 
         client.x = client.old_x;
@@ -1094,7 +1914,7 @@ fn set_fullscreen(display: *Display, client: *Client, fullscreen: bool) void {
         tiling.resize_client(client, client.x, client.y, client.width, client.height);
         arrange(monitor);
 
-        std.debug.print("fullscreen disabled: window=0x{x}\n", .{client.window});
+        log.info(.client, "fullscreen disabled: window=0x{x}", .{client.window});
     }
 }
 
@@ -1104,6 +1924,7 @@ fn view(display: *Display, tag_mask: u32) void {
         return;
     }
     monitor.sel_tags ^= 1;
+    monitor_mod.invalidate_tiled(monitor);
     if (tag_mask != 0) {
         monitor.tagset[monitor.sel_tags] = tag_mask;
         monitor.pertag.prevtag = monitor.pertag.curtag;
@@ -1130,7 +1951,8 @@ fn view(display: *Display, tag_mask: u32) void {
     focus_top_client(display, monitor);
     arrange(monitor);
     bar_mod.invalidate_bars();
-    std.debug.print("view: tag_mask={d}\n", .{monitor.tagset[monitor.sel_tags]});
+    publish_tags(monitor);
+    log.info(.layout, "view: tag_mask={d}", .{monitor.tagset[monitor.sel_tags]});
 }
 
 fn tag_client(display: *Display, tag_mask: u32) void {
@@ -1139,11 +1961,12 @@ fn tag_client(display: *Display, tag_mask: u32) void {
     if (tag_mask == 0) {
         return;
     }
-    client.tags = tag_mask;
+    client_mod.set_tags(client, tag_mask);
     focus_top_client(display, monitor);
     arrange(monitor);
     bar_mod.invalidate_bars();
-    std.debug.print("tag_client: window=0x{x} tag_mask={d}\n", .{ client.window, tag_mask });
+    publish_tags(monitor);
+    log.info(.client, "tag_client: window=0x{x} tag_mask={d}", .{ client.window, tag_mask });
 }
 
 fn focus_top_client(display: *Display, monitor: *Monitor) void {
@@ -1222,14 +2045,14 @@ fn toggle_floating(_: *Display) void {
         return;
     }
 
-    client.is_floating = !client.is_floating;
+    client_mod.set_floating(client, !client.is_floating);
 
     if (client.is_floating) {
         tiling.resize(client, client.x, client.y, client.width, client.height, false);
     }
 
     arrange(monitor);
-    std.debug.print("toggle_floating: window=0x{x} floating={}\n", .{ client.window, client.is_floating });
+    log.info(.client, "toggle_floating: window=0x{x} floating={}", .{ client.window, client.is_floating });
 }
 
 fn incnmaster(delta: i32) void {
@@ -1238,7 +2061,7 @@ fn incnmaster(delta: i32) void {
     monitor.nmaster = new_val;
     monitor.pertag.nmasters[monitor.pertag.curtag] = new_val;
     arrange(monitor);
-    std.debug.print("incnmaster: nmaster={d}\n", .{monitor.nmaster});
+    log.info(.layout, "incnmaster: nmaster={d}", .{monitor.nmaster});
 }
 
 fn setmfact(delta: f32) void {
@@ -1250,7 +2073,7 @@ fn setmfact(delta: f32) void {
     monitor.mfact = new_mfact;
     monitor.pertag.mfacts[monitor.pertag.curtag] = new_mfact;
     arrange(monitor);
-    std.debug.print("setmfact: mfact={d:.2}\n", .{monitor.mfact});
+    log.info(.layout, "setmfact: mfact={d:.2}", .{monitor.mfact});
 }
 
 fn cycle_layout() void {
@@ -1263,8 +2086,9 @@ fn cycle_layout() void {
     }
     arrange(monitor);
     bar_mod.invalidate_bars();
+    publish_layout(monitor);
     if (monitor.lt[monitor.sel_lt]) |layout| {
-        std.debug.print("cycle_layout: {s}\n", .{layout.symbol});
+        log.info(.layout, "cycle_layout: {s}", .{layout.symbol});
     }
 }
 
@@ -1281,7 +2105,7 @@ fn set_layout(layout_name: ?[]const u8) void {
     else if (std.mem.eql(u8, name, "scrolling") or std.mem.eql(u8, name, "[S]"))
         3
     else {
-        std.debug.print("set_layout: unknown layout '{s}'\n", .{name});
+        log.warn(.layout, "set_layout: unknown layout '{s}'", .{name});
         return;
     };
 
@@ -1292,8 +2116,9 @@ fn set_layout(layout_name: ?[]const u8) void {
     }
     arrange(monitor);
     bar_mod.invalidate_bars();
+    publish_layout(monitor);
     if (monitor.lt[monitor.sel_lt]) |layout| {
-        std.debug.print("set_layout: {s}\n", .{layout.symbol});
+        log.info(.layout, "set_layout: {s}", .{layout.symbol});
     }
 }
 
@@ -1306,7 +2131,8 @@ fn focusmon(display: *Display, direction: i32) void {
     unfocus_client(display, selmon.sel, false);
     monitor_mod.selected_monitor = target;
     focus(display, null);
-    std.debug.print("focusmon: monitor {d}\n", .{target.num});
+    ipc.publish(.monitor, "\"monitor\":{d}", .{target.num});
+    log.info(.layout, "focusmon: monitor {d}", .{target.num});
 }
 
 fn sendmon(display: *Display, direction: i32) void {
@@ -1329,7 +2155,7 @@ fn sendmon(display: *Display, direction: i32) void {
     arrange(source_monitor);
     arrange(target);
 
-    std.debug.print("sendmon: window=0x{x} to monitor {d}\n", .{ client.window, target.num });
+    log.info(.client, "sendmon: window=0x{x} to monitor {d}", .{ client.window, target.num });
 }
 
 fn snap_x(client: *Client, new_x: i32, monitor: *Monitor) i32 {
@@ -1352,7 +2178,34 @@ fn snap_y(client: *Client, new_y: i32, monitor: *Monitor) i32 {
     return new_y;
 }
 
-fn movemouse(display: *Display) void {
+const Drag_Mode = enum {
+    none,
+    move,
+    resize,
+};
+
+const Drag_State = struct {
+    mode: Drag_Mode = .none,
+    client: ?*Client = null,
+    monitor: ?*Monitor = null,
+    was_floating: bool = false,
+    start_x: i32 = 0,
+    start_y: i32 = 0,
+    pointer_start_x: i32 = 0,
+    pointer_start_y: i32 = 0,
+    pointer_x: i32 = 0,
+    pointer_y: i32 = 0,
+    has_motion: bool = false,
+    last_apply: i128 = 0,
+};
+
+const drag_frame_ns: i128 = 16 * std.time.ns_per_ms;
+
+var drag: Drag_State = .{};
+
+fn begin_drag(display: *Display, mode: Drag_Mode) void {
+    if (drag.mode != .none) return;
+
     const monitor = monitor_mod.selected_monitor orelse return;
     const client = monitor.sel orelse return;
 
@@ -1363,17 +2216,17 @@ fn movemouse(display: *Display) void {
     restack(display, monitor);
 
     const was_floating = client.is_floating;
-    if (!client.is_floating) {
-        client.is_floating = true;
-    }
+    client_mod.set_floating(client, true);
 
-    var root_x: c_int = undefined;
-    var root_y: c_int = undefined;
-    var dummy_win: xlib.Window = undefined;
-    var dummy_int: c_int = undefined;
-    var dummy_uint: c_uint = undefined;
+    var root_x: c_int = pointer_x;
+    var root_y: c_int = pointer_y;
 
-    _ = xlib.XQueryPointer(display.handle, display.root, &dummy_win, &dummy_win, &root_x, &root_y, &dummy_int, &dummy_int, &dummy_uint);
+    if (mode == .move and !pointer_known) {
+        var dummy_win: xlib.Window = undefined;
+        var dummy_int: c_int = undefined;
+        var dummy_uint: c_uint = undefined;
+        _ = xlib.XQueryPointer(display.handle, display.root, &dummy_win, &dummy_win, &root_x, &root_y, &dummy_int, &dummy_int, &dummy_uint);
+    }
 
     const grab_result = xlib.XGrabPointer(
         display.handle,
@@ -1383,51 +2236,118 @@ fn movemouse(display: *Display) void {
         xlib.GrabModeAsync,
         xlib.GrabModeAsync,
         xlib.None,
-        cursor_move,
+        if (mode == .move) cursor_move else cursor_resize,
         xlib.CurrentTime,
     );
 
     if (grab_result != xlib.GrabSuccess) {
+        client_mod.set_floating(client, was_floating);
         return;
     }
 
-    const start_x = client.x;
-    const start_y = client.y;
-    const pointer_start_x = root_x;
-    const pointer_start_y = root_y;
-    var last_time: c_ulong = 0;
+    if (mode == .resize) {
+        _ = xlib.XWarpPointer(display.handle, xlib.None, client.window, 0, 0, 0, 0, client.width + client.border_width - 1, client.height + client.border_width - 1);
+    }
 
-    var event: xlib.XEvent = undefined;
-    var done = false;
+    drag = .{
+        .mode = mode,
+        .client = client,
+        .monitor = monitor,
+        .was_floating = was_floating,
+        .start_x = client.x,
+        .start_y = client.y,
+        .pointer_start_x = root_x,
+        .pointer_start_y = root_y,
+    };
+}
 
-    while (!done) {
-        _ = xlib.XNextEvent(display.handle, &event);
+fn handle_drag_event(event: *xlib.XEvent, event_type: events.EventType) bool {
+    if (drag.mode == .none) return false;
 
-        switch (event.type) {
-            xlib.MotionNotify => {
-                const motion = &event.xmotion;
-                if ((motion.time - last_time) < (1000 / 60)) {
-                    continue;
+    switch (event_type) {
+        .motion_notify => {
+            drag.pointer_x = event.xmotion.x_root;
+            drag.pointer_y = event.xmotion.y_root;
+            drag.has_motion = true;
+            return true;
+        },
+        .button_release => {
+            if (display_global) |display| {
+                finish_drag(display);
+            }
+            return true;
+        },
+        .button_press => return true,
+        else => return false,
+    }
+}
+
+fn tick_drag() void {
+    if (drag.mode == .none or !drag.has_motion) return;
+
+    const now = std.time.nanoTimestamp();
+    if (now - drag.last_apply < drag_frame_ns) return;
+    drag.last_apply = now;
+    apply_drag();
+}
+
+fn apply_drag() void {
+    const client = drag.client orelse return;
+    drag.has_motion = false;
+
+    switch (drag.mode) {
+        .move => {
+            var new_x = drag.start_x + drag.pointer_x - drag.pointer_start_x;
+            var new_y = drag.start_y + drag.pointer_y - drag.pointer_start_y;
+            if (client.monitor) |client_monitor| {
+                new_x = snap_x(client, new_x, client_monitor);
+                new_y = snap_y(client, new_y, client_monitor);
+            }
+            tiling.resize(client, new_x, new_y, client.width, client.height, true);
+        },
+        .resize => {
+            var new_width = @max(1, drag.pointer_x - client.x - 2 * client.border_width + 1);
+            var new_height = @max(1, drag.pointer_y - client.y - 2 * client.border_width + 1);
+            if (client.monitor) |client_monitor| {
+                const client_right = client.x + new_width + 2 * client.border_width;
+                const client_bottom = client.y + new_height + 2 * client.border_width;
+                const mon_right = client_monitor.win_x + client_monitor.win_w;
+                const mon_bottom = client_monitor.win_y + client_monitor.win_h;
+                if (@abs(mon_right - client_right) < snap_distance) {
+                    new_width = @max(1, mon_right - client.x - 2 * client.border_width);
                 }
-                last_time = motion.time;
-                const delta_x = motion.x_root - pointer_start_x;
-                const delta_y = motion.y_root - pointer_start_y;
-                var new_x = start_x + delta_x;
-                var new_y = start_y + delta_y;
-                if (client.monitor) |client_monitor| {
-                    new_x = snap_x(client, new_x, client_monitor);
-                    new_y = snap_y(client, new_y, client_monitor);
+                if (@abs(mon_bottom - client_bottom) < snap_distance) {
+                    new_height = @max(1, mon_bottom - client.y - 2 * client.border_width);
                 }
-                tiling.resize(client, new_x, new_y, client.width, client.height, true);
-            },
-            xlib.ButtonRelease => {
-                done = true;
-            },
-            else => {},
-        }
+            }
+            tiling.resize(client, client.x, client.y, new_width, new_height, true);
+        },
+        .none => {},
     }
+}
 
+fn cancel_drag(display: *Display) void {
+    if (drag.mode == .none) return;
     _ = xlib.XUngrabPointer(display.handle, xlib.CurrentTime);
+    drag = .{};
+}
+
+fn finish_drag(display: *Display) void {
+    if (drag.has_motion) {
+        apply_drag();
+    }
+    _ = xlib.XUngrabPointer(display.handle, xlib.CurrentTime);
+
+    const state = drag;
+    drag = .{};
+
+    const client = state.client orelse return;
+    const monitor = state.monitor orelse return;
+
+    if (state.mode == .resize) {
+        arrange(monitor);
+        return;
+    }
 
     const new_mon = monitor_mod.rect_to_monitor(client.x, client.y, client.width, client.height);
     if (new_mon != null and new_mon != monitor) {
@@ -1445,7 +2365,7 @@ fn movemouse(display: *Display) void {
         arrange(monitor);
     }
 
-    if (config.auto_tile and !was_floating) {
+    if (config.auto_tile and !state.was_floating) {
         const drop_monitor = client.monitor orelse return;
         const center_x = client.x + @divTrunc(client.width, 2);
         const center_y = client.y + @divTrunc(client.height, 2);
@@ -1454,89 +2374,16 @@ fn movemouse(display: *Display) void {
             client_mod.insert_before(client, target);
         }
 
-        client.is_floating = false;
+        client_mod.set_floating(client, false);
         arrange(drop_monitor);
     }
 }
 
-fn resizemouse(display: *Display) void {
-    const monitor = monitor_mod.selected_monitor orelse return;
-    const client = monitor.sel orelse return;
-
-    if (client.is_fullscreen) {
-        return;
-    }
-
-    restack(display, monitor);
-
-    if (!client.is_floating) {
-        client.is_floating = true;
-    }
-
-    const grab_result = xlib.XGrabPointer(
-        display.handle,
-        display.root,
-        xlib.False,
-        xlib.ButtonPressMask | xlib.ButtonReleaseMask | xlib.PointerMotionMask,
-        xlib.GrabModeAsync,
-        xlib.GrabModeAsync,
-        xlib.None,
-        cursor_resize,
-        xlib.CurrentTime,
-    );
-
-    if (grab_result != xlib.GrabSuccess) {
-        return;
-    }
-
-    _ = xlib.XWarpPointer(display.handle, xlib.None, client.window, 0, 0, 0, 0, client.width + client.border_width - 1, client.height + client.border_width - 1);
-
-    var event: xlib.XEvent = undefined;
-    var done = false;
-    var last_time: c_ulong = 0;
-
-    while (!done) {
-        _ = xlib.XNextEvent(display.handle, &event);
-
-        switch (event.type) {
-            xlib.MotionNotify => {
-                const motion = &event.xmotion;
-                if ((motion.time - last_time) < (1000 / 60)) {
-                    continue;
-                }
-                last_time = motion.time;
-                var new_width = @max(1, motion.x_root - client.x - 2 * client.border_width + 1);
-                var new_height = @max(1, motion.y_root - client.y - 2 * client.border_width + 1);
-                if (client.monitor) |client_monitor| {
-                    const client_right = client.x + new_width + 2 * client.border_width;
-                    const client_bottom = client.y + new_height + 2 * client.border_width;
-                    const mon_right = client_monitor.win_x + client_monitor.win_w;
-                    const mon_bottom = client_monitor.win_y + client_monitor.win_h;
-                    if (@abs(mon_right - client_right) < snap_distance) {
-                        new_width = @max(1, mon_right - client.x - 2 * client.border_width);
-                    }
-                    if (@abs(mon_bottom - client_bottom) < snap_distance) {
-                        new_height = @max(1, mon_bottom - client.y - 2 * client.border_width);
-                    }
-                }
-                tiling.resize(client, client.x, client.y, new_width, new_height, true);
-            },
-            xlib.ButtonRelease => {
-                done = true;
-            },
-            else => {},
-        }
-    }
-
-    _ = xlib.XUngrabPointer(display.handle, xlib.CurrentTime);
-    arrange(monitor);
-}
-
 fn handle_expose(display: *Display, event: *xlib.XExposeEvent) void {
     if (event.count != 0) return;
 
     if (bar_mod.window_to_bar(event.window)) |bar| {
-        bar.invalidate();
+        bar.expose();
         bar.draw(display.handle, &tags);
     }
 }
@@ -1554,9 +2401,10 @@ fn clean_mask(mask: c_uint) c_uint {
 }
 
 fn handle_button_press(display: *Display, event: *xlib.XButtonEvent) void {
-    std.debug.print("button_press: window=0x{x} subwindow=0x{x}\n", .{ event.window, event.subwindow });
+    log.debug(.event, "button_press: window=0x{x} subwindow=0x{x}", .{ event.window, event.subwindow });
 
-    const clicked_monitor = monitor_mod.window_to_monitor(event.window);
+    track_pointer(event.x_root, event.y_root);
+    const clicked_monitor = monitor_mod.window_to_monitor(event.window, event.x_root, event.y_root);
     if (clicked_monitor) |monitor| {
         if (monitor != monitor_mod.selected_monitor) {
             if (monitor_mod.selected_monitor) |selmon| {
@@ -1591,11 +2439,11 @@ fn handle_button_press(display: *Display, event: *xlib.XButtonEvent) void {
         const button_clean_mask = clean_mask(button.mod_mask);
         if (clean_state == button_clean_mask and event.button == button.button) {
             switch (button.action) {
-                .move_mouse => movemouse(display),
-                .resize_mouse => resizemouse(display),
+                .move_mouse => begin_drag(display, .move),
+                .resize_mouse => begin_drag(display, .resize),
                 .toggle_floating => {
                     if (click_client) |found_client| {
-                        found_client.is_floating = !found_client.is_floating;
+                        client_mod.set_floating(found_client, !found_client.is_floating);
                         if (monitor_mod.selected_monitor) |monitor| {
                             arrange(monitor);
                         }
@@ -1638,17 +2486,25 @@ fn handle_client_message(display: *Display, event: *xlib.XClientMessageEvent) vo
 
 fn handle_destroy_notify(display: *Display, event: *xlib.XDestroyWindowEvent) void {
     const client = client_mod.window_to_client(event.window) orelse return;
-    std.debug.print("destroy_notify: window=0x{x}\n", .{event.window});
+    log.debug(.event, "destroy_notify: window=0x{x}", .{event.window});
     unmanage(display, client);
 }
 
 fn handle_unmap_notify(display: *Display, event: *xlib.XUnmapEvent) void {
     const client = client_mod.window_to_client(event.window) orelse return;
-    std.debug.print("unmap_notify: window=0x{x}\n", .{event.window});
+    if (event.send_event == 0 and client.ignore_unmap > 0) {
+        client.ignore_unmap -= 1;
+        return;
+    }
+    log.debug(.event, "unmap_notify: window=0x{x}", .{event.window});
     unmanage(display, client);
 }
 
 fn unmanage(display: *Display, client: *Client) void {
+    if (drag.client == client) {
+        cancel_drag(display);
+    }
+
     const client_monitor = client.monitor;
 
     var next_focus: ?*Client = null;
@@ -1692,8 +2548,9 @@ fn unmanage(display: *Display, client: *Client) void {
         }
     }
 
+    const window = client.window;
     client_mod.destroy(client);
-    update_client_list(display);
+    client_list.remove(window);
     bar_mod.invalidate_bars();
 }
 
@@ -1702,8 +2559,9 @@ fn handle_enter_notify(display: *Display, event: *xlib.XCrossingEvent) void {
         return;
     }
 
+    track_pointer(event.x_root, event.y_root);
     const client = client_mod.window_to_client(event.window);
-    const target_mon = if (client) |c| c.monitor else monitor_mod.window_to_monitor(event.window);
+    const target_mon = if (client) |c| c.monitor else monitor_mod.window_to_monitor(event.window, event.x_root, event.y_root);
     const selmon = monitor_mod.selected_monitor;
 
     if (target_mon != selmon) {
@@ -1739,13 +2597,30 @@ fn set_focus(display: *Display, client: *Client) void {
 }
 
 var last_motion_monitor: ?*Monitor = null;
+var pointer_x: i32 = 0;
+var pointer_y: i32 = 0;
+var pointer_known: bool = false;
+
+fn track_pointer(x_root: i32, y_root: i32) void {
+    pointer_x = x_root;
+    pointer_y = y_root;
+    pointer_known = true;
+}
 
 fn handle_motion_notify(display: *Display, event: *xlib.XMotionEvent) void {
     if (event.window != display.root) {
         return;
     }
 
-    const target_mon = monitor_mod.rect_to_monitor(event.x_root, event.y_root, 1, 1);
+    var latest = event.*;
+    var queued: xlib.XEvent = undefined;
+    while (xlib.XCheckTypedWindowEvent(display.handle, display.root, xlib.MotionNotify, &queued) != 0) {
+        record_event(&queued, trace.now());
+        latest = queued.xmotion;
+    }
+    track_pointer(latest.x_root, latest.y_root);
+
+    const target_mon = monitor_mod.point_to_monitor(latest.x_root, latest.y_root);
     if (target_mon != last_motion_monitor and last_motion_monitor != null) {
         if (monitor_mod.selected_monitor) |selmon| {
             unfocus_client(display, selmon.sel, true);
@@ -1766,7 +2641,7 @@ fn handle_property_notify(display: *Display, event: *xlib.XPropertyEvent) void {
     if (event.atom == xlib.XA_WM_TRANSIENT_FOR) {
         var trans: xlib.Window = 0;
         if (!client.is_floating and xlib.XGetTransientForHint(display.handle, client.window, &trans) != 0) {
-            client.is_floating = client_mod.window_to_client(trans) != null;
+            client_mod.set_floating(client, client_mod.window_to_client(trans) != null);
             if (client.is_floating) {
                 if (client.monitor) |monitor| {
                     arrange(monitor);
@@ -1774,14 +2649,42 @@ fn handle_property_notify(display: *Display, event: *xlib.XPropertyEvent) void {
             }
         }
     } else if (event.atom == xlib.XA_WM_NORMAL_HINTS) {
-        client.hints_valid = false;
+        properties.mark(client, properties.size_hints);
+        if (client.monitor) |monitor| {
+            monitor_mod.invalidate_tiled(monitor);
+        }
     } else if (event.atom == xlib.XA_WM_HINTS) {
-        update_wm_hints(display, client);
-        bar_mod.invalidate_bars();
+        properties.mark(client, properties.wm_hints);
     } else if (event.atom == xlib.XA_WM_NAME or event.atom == net_wm_name) {
-        update_title(display, client);
+        properties.mark(client, properties.title);
+        if (ipc.has_subscribers(.title)) {
+            ipc.publish(.title, "\"window\":{d},\"title\":{f}", .{ client.window, ipc.json(properties.get_title(client)) });
+        }
+    } else if (event.atom == xlib.XA_WM_CLASS) {
+        properties.mark(client, properties.class);
     } else if (event.atom == net_wm_window_type) {
-        update_window_type(display, client);
+        properties.mark(client, properties.window_type);
+    }
+}
+
+fn flush_property_updates(display: *Display) void {
+    if (!properties.take_pending()) return;
+
+    var current_monitor = monitor_mod.monitors;
+    while (current_monitor) |monitor| {
+        var current = monitor.clients;
+        while (current) |client| {
+            const next = client.next;
+            if (properties.take(client, properties.wm_hints)) {
+                update_wm_hints(display, client);
+                bar_mod.invalidate_bars();
+            }
+            if (properties.take(client, properties.window_type)) {
+                update_window_type(display, client);
+            }
+            current = next;
+        }
+        current_monitor = monitor.next;
     }
 }
 
@@ -1897,11 +2800,20 @@ fn focus(display: *Display, target_client: ?*Client) void {
     }
 
     const current_selmon = monitor_mod.selected_monitor orelse return;
+    const previous_focus = current_selmon.sel;
     current_selmon.sel = focus_client;
+    if (previous_focus != focus_client) {
+        ipc.publish(.focus, "\"monitor\":{d},\"window\":{d}", .{
+            current_selmon.num,
+            if (focus_client) |client| client.window else 0,
+        });
+    }
 
     if (focus_client) |client| {
         if (is_scrolling_layout(current_selmon)) {
             scroll_to_window(client, true);
+        } else if (is_monocle_layout(current_selmon)) {
+            monocle.fit(current_selmon, client);
         }
     }
 
@@ -1931,6 +2843,7 @@ fn restack(display: *Display, monitor: *Monitor) void {
         }
     }
 
+    client_list.sync_stacking();
     _ = xlib.XSync(display.handle, xlib.False);
 
     var discard_event: xlib.XEvent = undefined;
@@ -1968,6 +2881,13 @@ fn is_scrolling_layout(monitor: *Monitor) bool {
     return false;
 }
 
+fn is_monocle_layout(monitor: *Monitor) bool {
+    if (monitor.lt[monitor.sel_lt]) |layout| {
+        return layout.arrange_fn == monocle.layout.arrange_fn;
+    }
+    return false;
+}
+
 fn scroll_layout(direction: i32) void {
     const monitor = monitor_mod.selected_monitor orelse return;
     if (!is_scrolling_layout(monitor)) return;
@@ -2000,82 +2920,63 @@ fn scroll_to_window(client: *Client, animate: bool) void {
     }
 }
 
-fn showhide_client(display: *Display, client: ?*Client) void {
-    const target = client orelse return;
-    if (client_mod.is_visible(target)) {
-        _ = xlib.XMoveWindow(display.handle, target.window, target.x, target.y);
-        const monitor = target.monitor orelse return;
-        if ((monitor.lt[monitor.sel_lt] == null or target.is_floating) and !target.is_fullscreen) {
-            tiling.resize(target, target.x, target.y, target.width, target.height, false);
+fn showhide(display: *Display, monitor: *Monitor) void {
+    var current = monitor.stack;
+    while (current) |client| : (current = client.stack_next) {
+        if (client_mod.is_visible(client)) {
+            show_client(display, client);
+        }
+    }
+    current = monitor.stack;
+    while (current) |client| : (current = client.stack_next) {
+        if (!client_mod.is_visible(client)) {
+            hide_client(display, client);
         }
-        showhide_client(display, target.stack_next);
-    } else {
-        showhide_client(display, target.stack_next);
-        const client_width = target.width + 2 * target.border_width;
-        _ = xlib.XMoveWindow(display.handle, target.window, -2 * client_width, target.y);
     }
 }
 
-fn showhide(display: *Display, monitor: *Monitor) void {
-    showhide_client(display, monitor.stack);
-}
-
-fn update_size_hints(display: *Display, client: *Client) void {
-    var size_hints: xlib.XSizeHints = undefined;
-    var msize: c_long = 0;
-
-    if (xlib.XGetWMNormalHints(display.handle, client.window, &size_hints, &msize) == 0) {
-        size_hints.flags = xlib.PSize;
+fn show_client(display: *Display, client: *Client) void {
+    if (client.visibility != .shown) {
+        _ = xlib.XMoveWindow(display.handle, client.window, client.x, client.y);
+        if (client.visibility == .unmapped) {
+            _ = xlib.XMapWindow(display.handle, client.window);
+            set_client_state(display, client, NormalState);
+        }
+        client.visibility = .shown;
     }
-
-    if ((size_hints.flags & xlib.PBaseSize) != 0) {
-        client.base_width = size_hints.base_width;
-        client.base_height = size_hints.base_height;
-    } else if ((size_hints.flags & xlib.PMinSize) != 0) {
-        client.base_width = size_hints.min_width;
-        client.base_height = size_hints.min_height;
-    } else {
-        client.base_width = 0;
-        client.base_height = 0;
+    const monitor = client.monitor orelse return;
+    if ((monitor.lt[monitor.sel_lt] == null or client.is_floating) and !client.is_fullscreen) {
+        tiling.resize(client, client.x, client.y, client.width, client.height, false);
     }
+}
 
-    if ((size_hints.flags & xlib.PResizeInc) != 0) {
-        client.increment_width = size_hints.width_inc;
-        client.increment_height = size_hints.height_inc;
-    } else {
-        client.increment_width = 0;
-        client.increment_height = 0;
-    }
+fn hide_client(display: *Display, client: *Client) void {
+    if (client.visibility == .moved or client.visibility == .unmapped) return;
 
-    if ((size_hints.flags & xlib.PMaxSize) != 0) {
-        client.max_width = size_hints.max_width;
-        client.max_height = size_hints.max_height;
-    } else {
-        client.max_width = 0;
-        client.max_height = 0;
+    if (config.hide_unmap and client.visibility == .shown) {
+        client.ignore_unmap += 2;
+        _ = xlib.XUnmapWindow(display.handle, client.window);
+        set_client_state(display, client, IconicState);
+        client.visibility = .unmapped;
+        return;
     }
 
-    if ((size_hints.flags & xlib.PMinSize) != 0) {
-        client.min_width = size_hints.min_width;
-        client.min_height = size_hints.min_height;
-    } else if ((size_hints.flags & xlib.PBaseSize) != 0) {
-        client.min_width = size_hints.base_width;
-        client.min_height = size_hints.base_height;
-    } else {
-        client.min_width = 0;
-        client.min_height = 0;
-    }
+    const client_width = client.width + 2 * client.border_width;
+    _ = xlib.XMoveWindow(display.handle, client.window, -2 * client_width, client.y);
+    client.visibility = .moved;
+}
 
-    if ((size_hints.flags & xlib.PAspect) != 0) {
-        client.min_aspect = @as(f32, @floatFromInt(size_hints.min_aspect.y)) / @as(f32, @floatFromInt(size_hints.min_aspect.x));
-        client.max_aspect = @as(f32, @floatFromInt(size_hints.max_aspect.x)) / @as(f32, @floatFromInt(size_hints.max_aspect.y));
-    } else {
-        client.min_aspect = 0.0;
-        client.max_aspect = 0.0;
+fn release_hidden_clients(display: *Display) void {
+    var current_monitor = monitor_mod.monitors;
+    while (current_monitor) |monitor| : (current_monitor = monitor.next) {
+        var current = monitor.clients;
+        while (current) |client| : (current = client.next) {
+            if (client.visibility != .unmapped) continue;
+            _ = xlib.XMapWindow(display.handle, client.window);
+            set_client_state(display, client, NormalState);
+        }
     }
-
-    client.is_fixed = (client.max_width != 0 and client.max_height != 0 and client.max_width == client.min_width and client.max_height == client.min_height);
-    client.hints_valid = true;
+    _ = xlib.XSync(display.handle, xlib.False);
 }
 
 fn update_wm_hints(display: *Display, client: *Client) void {
@@ -2087,7 +2988,7 @@ fn update_wm_hints(display: *Display, client: *Client) void {
             hints.*.flags = hints.*.flags & ~@as(c_long, xlib.XUrgencyHint);
             _ = xlib.XSetWMHints(display.handle, client.window, hints);
         } else {
-            client.is_urgent = (hints.*.flags & xlib.XUrgencyHint) != 0;
+            client_mod.set_urgent(client, (hints.*.flags & xlib.XUrgencyHint) != 0);
         }
 
         if ((hints.*.flags & xlib.InputHint) != 0) {
@@ -2099,23 +3000,15 @@ fn update_wm_hints(display: *Display, client: *Client) void {
 }
 
 fn update_window_type(display: *Display, client: *Client) void {
-    const state = get_atom_prop(display, client, net_wm_state);
-    const window_type = get_atom_prop(display, client, net_wm_window_type);
+    apply_window_type(display, client, get_atom_prop(display, client, net_wm_state), get_atom_prop(display, client, net_wm_window_type));
+}
 
+fn apply_window_type(display: *Display, client: *Client, state: xlib.Atom, window_type: xlib.Atom) void {
     if (state == net_wm_state_fullscreen) {
         set_fullscreen(display, client, true);
     }
     if (window_type == net_wm_window_type_dialog) {
-        client.is_floating = true;
-    }
-}
-
-fn update_title(display: *Display, client: *Client) void {
-    if (!get_text_prop(display, client.window, net_wm_name, &client.name)) {
-        _ = get_text_prop(display, client.window, xlib.XA_WM_NAME, &client.name);
-    }
-    if (client.name[0] == 0) {
-        @memcpy(client.name[0..6], "broken");
+        client_mod.set_floating(client, true);
     }
 }
 
@@ -2134,94 +3027,42 @@ fn get_atom_prop(display: *Display, client: *Client, prop: xlib.Atom) xlib.Atom
     return 0;
 }
 
-fn get_text_prop(display: *Display, window: xlib.Window, atom: xlib.Atom, text: *[256]u8) bool {
-    var name: xlib.XTextProperty = undefined;
-    text[0] = 0;
-
-    if (xlib.XGetTextProperty(display.handle, window, &name, atom) == 0 or name.nitems == 0) {
-        return false;
-    }
-
-    if (name.encoding == xlib.XA_STRING) {
-        const len = @min(name.nitems, 255);
-        @memcpy(text[0..len], name.value[0..len]);
-        text[len] = 0;
-    } else {
-        var list: [*c][*c]u8 = undefined;
-        var count: c_int = undefined;
-        if (xlib.XmbTextPropertyToTextList(display.handle, &name, &list, &count) >= xlib.Success and count > 0 and list[0] != null) {
-            const str = std.mem.sliceTo(list[0], 0);
-            const copy_len = @min(str.len, 255);
-            @memcpy(text[0..copy_len], str[0..copy_len]);
-            text[copy_len] = 0;
-            xlib.XFreeStringList(list);
-        }
-    }
-    text[255] = 0;
-    _ = xlib.XFree(@ptrCast(name.value));
-    return true;
-}
-
-fn apply_rules(display: *Display, client: *Client) void {
-    var class_hint: xlib.XClassHint = .{ .res_name = null, .res_class = null };
-    _ = xlib.XGetClassHint(display.handle, client.window, &class_hint);
+fn apply_rules(client: *Client) void {
+    const class_str = properties.get_class(client);
+    const instance_str = properties.get_instance(client);
+    const needs_title = if (rule_matcher) |*matcher| matcher.uses_title() else rules.uses_title(config.rules.items);
+    const title_str = if (needs_title) properties.get_title(client) else "";
 
-    const class_str: []const u8 = if (class_hint.res_class) |ptr| std.mem.sliceTo(ptr, 0) else "";
-    const instance_str: []const u8 = if (class_hint.res_name) |ptr| std.mem.sliceTo(ptr, 0) else "";
+    var monitor_count: usize = 0;
+    var counted = monitor_mod.monitors;
+    while (counted) |mon| : (counted = mon.next) monitor_count += 1;
 
-    client.is_floating = false;
-    client.tags = 0;
-
-    for (config.rules.items) |rule| {
-        const class_matches = if (rule.class) |rc| std.mem.indexOf(u8, class_str, rc) != null else true;
-        const instance_matches = if (rule.instance) |ri| std.mem.indexOf(u8, instance_str, ri) != null else true;
-        const title_matches = if (rule.title) |rt| std.mem.indexOf(u8, std.mem.sliceTo(&client.name, 0), rt) != null else true;
-
-        if (class_matches and instance_matches and title_matches) {
-            client.is_floating = rule.is_floating;
-            client.tags |= rule.tags;
-            if (rule.monitor >= 0) {
-                var target = monitor_mod.monitors;
-                var index: i32 = 0;
-                while (target) |mon| {
-                    if (index == rule.monitor) {
-                        client.monitor = mon;
-                        break;
-                    }
-                    index += 1;
-                    target = mon.next;
-                }
+    const outcome = if (rule_matcher) |*matcher|
+        matcher.match(class_str, instance_str, title_str, monitor_count)
+    else
+        rules.match_linear(config.rules.items, class_str, instance_str, title_str, monitor_count);
+
+    client.is_floating = outcome.is_floating;
+    client.tags = outcome.tags;
+    if (outcome.monitor >= 0) {
+        var target = monitor_mod.monitors;
+        var index: i32 = 0;
+        while (target) |mon| {
+            if (index == outcome.monitor) {
+                client.monitor = mon;
+                break;
             }
+            index += 1;
+            target = mon.next;
         }
     }
 
-    if (class_hint.res_class) |ptr| {
-        _ = xlib.XFree(@ptrCast(ptr));
-    }
-    if (class_hint.res_name) |ptr| {
-        _ = xlib.XFree(@ptrCast(ptr));
-    }
-
     const monitor = client.monitor orelse return;
     if (client.tags == 0) {
         client.tags = monitor.tagset[monitor.sel_tags];
     }
 }
 
-fn update_client_list(display: *Display) void {
-    _ = xlib.XDeleteProperty(display.handle, display.root, net_client_list);
-
-    var current_monitor = monitor_mod.monitors;
-    while (current_monitor) |monitor| {
-        var current_client = monitor.clients;
-        while (current_client) |client| {
-            _ = xlib.XChangeProperty(display.handle, display.root, net_client_list, xlib.XA_WINDOW, 32, xlib.PropModeAppend, @ptrCast(&client.window), 1);
-            current_client = client.next;
-        }
-        current_monitor = monitor.next;
-    }
-}
-
 fn send_event(display: *Display, client: *Client, protocol: xlib.Atom) bool {
     var protocols: [*c]xlib.Atom = undefined;
     var num_protocols: c_int = 0;
@@ -2252,7 +3093,8 @@ fn send_event(display: *Display, client: *Client, protocol: xlib.Atom) bool {
 }
 
 fn set_urgent(display: *Display, client: *Client, urgent: bool) void {
-    client.is_urgent = urgent;
+    client_mod.set_urgent(client, urgent);
+    bar_mod.invalidate_bars();
     const wmh = xlib.XGetWMHints(display.handle, client.window);
     if (wmh) |hints| {
         if (urgent) {
@@ -2264,3 +3106,14 @@ fn set_urgent(display: *Display, client: *Client, urgent: bool) void {
         _ = xlib.XFree(@ptrCast(hints));
     }
 }
+
+test {
+    _ = @import("bar/blocks/uevent.zig");
+    _ = @import("bar/blocks/battery.zig");
+    _ = @import("bar/blocks/scan.zig");
+    _ = @import("bar/blocks/cpu_usage.zig");
+    _ = @import("bar/blocks/net_rate.zig");
+    _ = @import("bar/blocks/file.zig");
+    _ = @import("spawn.zig");
+    _ = @import("rules.zig");
+}
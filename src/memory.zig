@@ -0,0 +1,122 @@
+const std = @import("std");
+
+pub const Subsystem = enum { core, config, client, monitor, bar, ipc, spawn, rules, keys };
+
+const subsystem_count = @typeInfo(Subsystem).@"enum".fields.len;
+
+pub const Account = struct {
+    parent: std.mem.Allocator = undefined,
+    live_bytes: usize = 0,
+    peak_bytes: usize = 0,
+    allocations: usize = 0,
+
+    const vtable = std.mem.Allocator.VTable{
+        .alloc = alloc,
+        .resize = resize,
+        .remap = remap,
+        .free = free,
+    };
+
+    pub fn allocator(self: *Account) std.mem.Allocator {
+        return .{ .ptr = self, .vtable = &vtable };
+    }
+
+    fn grew(self: *Account, bytes: usize) void {
+        self.live_bytes += bytes;
+        self.peak_bytes = @max(self.peak_bytes, self.live_bytes);
+    }
+
+    fn alloc(context: *anyopaque, len: usize, alignment: std.mem.Alignment, ret_addr: usize) ?[*]u8 {
+        const self: *Account = @ptrCast(@alignCast(context));
+        const memory = self.parent.rawAlloc(len, alignment, ret_addr) orelse return null;
+        self.allocations += 1;
+        self.grew(len);
+        return memory;
+    }
+
+    fn resize(context: *anyopaque, memory: []u8, alignment: std.mem.Alignment, new_len: usize, ret_addr: usize) bool {
+        const self: *Account = @ptrCast(@alignCast(context));
+        if (!self.parent.rawResize(memory, alignment, new_len, ret_addr)) return false;
+        self.live_bytes -= memory.len;
+        self.grew(new_len);
+        return true;
+    }
+
+    fn remap(context: *anyopaque, memory: []u8, alignment: std.mem.Alignment, new_len: usize, ret_addr: usize) ?[*]u8 {
+        const self: *Account = @ptrCast(@alignCast(context));
+        const result = self.parent.rawRemap(memory, alignment, new_len, ret_addr) orelse return null;
+        self.live_bytes -= memory.len;
+        self.grew(new_len);
+        return result;
+    }
+
+    fn free(context: *anyopaque, memory: []u8, alignment: std.mem.Alignment, ret_addr: usize) void {
+        const self: *Account = @ptrCast(@alignCast(context));
+        self.parent.rawFree(memory, alignment, ret_addr);
+        self.live_bytes -= memory.len;
+        self.allocations -= 1;
+    }
+};
+
+pub const Pool_Stats = struct {
+    live: usize = 0,
+    peak: usize = 0,
+    capacity: usize = 0,
+    bytes: usize = 0,
+};
+
+pub const Report = struct {
+    clients: Pool_Stats = .{},
+    monitors: Pool_Stats = .{},
+    title_chunks: usize = 0,
+    title_used_bytes: usize = 0,
+    title_pool_bytes: usize = 0,
+    bars: usize = 0,
+    blocks: usize = 0,
+    block_bytes: usize = 0,
+    surface_bytes: usize = 0,
+    goon_bytes: usize = 0,
+};
+
+var accounts: [subsystem_count]Account = [_]Account{.{}} ** subsystem_count;
+
+pub fn init(parent: std.mem.Allocator) void {
+    for (&accounts) |*account| account.parent = parent;
+}
+
+pub fn allocator(subsystem: Subsystem) std.mem.Allocator {
+    return accounts[@intFromEnum(subsystem)].allocator();
+}
+
+pub fn write_text(report: *const Report, writer: *std.Io.Writer) !void {
+    try writer.print("{s:<10} {s:>12} {s:>12} {s:>8}\n", .{ "subsystem", "live bytes", "peak bytes", "allocs" });
+    for (accounts, 0..) |account, index| {
+        const subsystem: Subsystem = @enumFromInt(index);
+        try writer.print("{s:<10} {d:>12} {d:>12} {d:>8}\n", .{ @tagName(subsystem), account.live_bytes, account.peak_bytes, account.allocations });
+    }
+    try writer.print("\nclients    live={d} peak={d} slots={d} slab={d}B\n", .{ report.clients.live, report.clients.peak, report.clients.capacity, report.clients.bytes });
+    try writer.print("monitors   live={d} peak={d} slots={d} slab={d}B\n", .{ report.monitors.live, report.monitors.peak, report.monitors.capacity, report.monitors.bytes });
+    try writer.print("titles     chunks={d} used={d}B pool={d}B\n", .{ report.title_chunks, report.title_used_bytes, report.title_pool_bytes });
+    try writer.print("bars       bars={d} blocks={d} block buffers={d}B surfaces={d}B\n", .{ report.bars, report.blocks, report.block_bytes, report.surface_bytes });
+    try writer.print("goon       arena={d}B\n", .{report.goon_bytes});
+}
+
+pub fn write_json(report: *const Report, writer: *std.Io.Writer) !void {
+    try writer.writeAll("{\"subsystems\":{");
+    for (accounts, 0..) |account, index| {
+        const subsystem: Subsystem = @enumFromInt(index);
+        if (index > 0) try writer.writeByte(',');
+        try writer.print("\"{s}\":{{\"live\":{d},\"peak\":{d},\"allocations\":{d}}}", .{ @tagName(subsystem), account.live_bytes, account.peak_bytes, account.allocations });
+    }
+    try writer.writeAll("},");
+    try write_pool(writer, "clients", report.clients);
+    try writer.writeByte(',');
+    try write_pool(writer, "monitors", report.monitors);
+    try writer.print(",\"titles\":{{\"chunks\":{d},\"used\":{d},\"pool\":{d}}}", .{ report.title_chunks, report.title_used_bytes, report.title_pool_bytes });
+    try writer.print(",\"bars\":{{\"count\":{d},\"blocks\":{d},\"block_bytes\":{d},\"surface_bytes\":{d}}}", .{ report.bars, report.blocks, report.block_bytes, report.surface_bytes });
+    try writer.print(",\"goon_bytes\":{d}}}", .{report.goon_bytes});
+}
+
+fn write_pool(writer: *std.Io.Writer, name: []const u8, stats: Pool_Stats) !void {
+    try writer.print("\"{s}\":{{\"live\":{d},\"peak\":{d},\"slots\":{d},\"bytes\":{d}}}", .{ name, stats.live, stats.peak, stats.capacity, stats.bytes });
+}
@@ -1,6 +1,9 @@
 const std = @import("std");
 const xlib = @import("x11/xlib.zig");
 const Client = @import("client.zig").Client;
+const geometry = @import("layouts/geometry.zig");
+const slab = @import("slab.zig");
+const memory = @import("memory.zig");
 
 pub const Layout = struct {
     symbol: []const u8,
@@ -39,9 +42,18 @@ pub const Monitor = struct {
     sel_tags: u32 = 0,
     sel_lt: u32 = 0,
     tagset: [2]u32 = .{ 1, 1 },
+    tag_counts: [32]u16 = [_]u16{0} ** 32,
+    urgent_counts: [32]u16 = [_]u16{0} ** 32,
+    occupied_mask: u32 = 0,
+    urgent_mask: u32 = 0,
     show_bar: bool = true,
     top_bar: bool = true,
     clients: ?*Client = null,
+    tiled: std.ArrayListUnmanaged(geometry.Tiled) = .{},
+    tiled_clients: std.ArrayListUnmanaged(*Client) = .{},
+    tiled_dirty: bool = true,
+    plan: std.ArrayListUnmanaged(geometry.Placement) = .{},
+    monocle_area: ?geometry.Area = null,
     sel: ?*Client = null,
     stack: ?*Client = null,
     next: ?*Monitor = null,
@@ -54,19 +66,108 @@ pub var monitors: ?*Monitor = null;
 pub var selected_monitor: ?*Monitor = null;
 
 var allocator: std.mem.Allocator = undefined;
+var monitor_slab: slab.Slab(Monitor, 8) = .{};
 
 pub fn init(alloc: std.mem.Allocator) void {
     allocator = alloc;
 }
 
+pub fn deinit() void {
+    var current = monitors;
+    while (current) |mon| {
+        current = mon.next;
+        destroy(mon);
+    }
+    monitors = null;
+    selected_monitor = null;
+    monitor_slab.deinit(allocator);
+}
+
 pub fn create() ?*Monitor {
-    const mon = allocator.create(Monitor) catch return null;
+    const mon = monitor_slab.create(allocator) catch return null;
     mon.* = Monitor{};
     return mon;
 }
 
 pub fn destroy(mon: *Monitor) void {
-    allocator.destroy(mon);
+    mon.tiled.deinit(allocator);
+    mon.tiled_clients.deinit(allocator);
+    mon.plan.deinit(allocator);
+    monitor_slab.destroy(mon);
+}
+
+pub fn fill_memory_report(report: *memory.Report) void {
+    report.monitors = .{ .live = monitor_slab.live, .peak = monitor_slab.peak, .capacity = monitor_slab.capacity(), .bytes = monitor_slab.bytes() };
+}
+
+pub fn invalidate_tiled(mon: *Monitor) void {
+    mon.tiled_dirty = true;
+}
+
+pub fn tiled_clients(mon: *Monitor) []const *Client {
+    refresh_tiled(mon);
+    return mon.tiled_clients.items;
+}
+
+pub fn tiled_frames(mon: *Monitor) []geometry.Tiled {
+    refresh_tiled(mon);
+    return mon.tiled.items;
+}
+
+fn refresh_tiled(mon: *Monitor) void {
+    if (!mon.tiled_dirty) return;
+
+    const client_mod = @import("client.zig");
+    const properties = @import("properties.zig");
+    mon.tiled.clearRetainingCapacity();
+    mon.tiled_clients.clearRetainingCapacity();
+    var current = client_mod.next_tiled(mon.clients);
+    while (current) |client| : (current = client_mod.next_tiled(client.next)) {
+        mon.tiled.ensureUnusedCapacity(allocator, 1) catch return;
+        mon.tiled_clients.ensureUnusedCapacity(allocator, 1) catch return;
+        properties.ensure_size_hints(client);
+        mon.tiled.appendAssumeCapacity(client_mod.to_tiled(client));
+        mon.tiled_clients.appendAssumeCapacity(client);
+    }
+    mon.tiled_dirty = false;
+}
+
+pub fn count_client(mon: *Monitor, tags: u32, urgent: bool) void {
+    var bits = tags;
+    while (bits != 0) : (bits &= bits - 1) {
+        const index = @ctz(bits);
+        mon.tag_counts[index] += 1;
+        if (urgent) {
+            mon.urgent_counts[index] += 1;
+        }
+    }
+    mon.occupied_mask |= tags;
+    if (urgent) {
+        mon.urgent_mask |= tags;
+    }
+}
+
+pub fn uncount_client(mon: *Monitor, tags: u32, urgent: bool) void {
+    var bits = tags;
+    while (bits != 0) : (bits &= bits - 1) {
+        const index = @ctz(bits);
+        const bit = @as(u32, 1) << @intCast(index);
+        mon.tag_counts[index] -= 1;
+        if (mon.tag_counts[index] == 0) {
+            mon.occupied_mask &= ~bit;
+        }
+        if (urgent) {
+            mon.urgent_counts[index] -= 1;
+            if (mon.urgent_counts[index] == 0) {
+                mon.urgent_mask &= ~bit;
+            }
+        }
+    }
+}
+
+pub fn layout_plan(mon: *Monitor, len: usize) ?[]geometry.Placement {
+    mon.plan.resize(allocator, len) catch return null;
+    return mon.plan.items;
 }
 
 var root_window: xlib.Window = 0;
@@ -77,16 +178,9 @@ pub fn set_root_window(root: xlib.Window, display: *xlib.Display) void {
     display_handle = display;
 }
 
-pub fn window_to_monitor(win: xlib.Window) ?*Monitor {
-    if (win == root_window and display_handle != null) {
-        var root_x: c_int = undefined;
-        var root_y: c_int = undefined;
-        var dummy_win: xlib.Window = undefined;
-        var dummy_int: c_int = undefined;
-        var dummy_uint: c_uint = undefined;
-        if (xlib.XQueryPointer(display_handle.?, root_window, &dummy_win, &dummy_win, &root_x, &root_y, &dummy_int, &dummy_int, &dummy_uint) != 0) {
-            return rect_to_monitor(root_x, root_y, 1, 1);
-        }
+pub fn window_to_monitor(win: xlib.Window, root_x: i32, root_y: i32) ?*Monitor {
+    if (win == root_window) {
+        return point_to_monitor(root_x, root_y);
     }
 
     var current = monitors;
@@ -123,6 +217,89 @@ pub fn rect_to_monitor(x: i32, y: i32, width: i32, height: i32) ?*Monitor {
     return result;
 }
 
+const Monitor_Index = struct {
+    x_edges: std.ArrayListUnmanaged(i32) = .{},
+    y_edges: std.ArrayListUnmanaged(i32) = .{},
+    cells: std.ArrayListUnmanaged(?*Monitor) = .{},
+    dirty: bool = true,
+};
+
+var monitor_index: Monitor_Index = .{};
+
+pub fn invalidate_index() void {
+    monitor_index.dirty = true;
+}
+
+pub fn point_to_monitor(x: i32, y: i32) ?*Monitor {
+    if (monitor_index.dirty) {
+        rebuild_index() catch return rect_to_monitor(x, y, 1, 1);
+    }
+    const column = find_span(monitor_index.x_edges.items, x) orelse return selected_monitor;
+    const row = find_span(monitor_index.y_edges.items, y) orelse return selected_monitor;
+    const columns = monitor_index.x_edges.items.len - 1;
+    return monitor_index.cells.items[row * columns + column] orelse selected_monitor;
+}
+
+fn rebuild_index() !void {
+    monitor_index.x_edges.clearRetainingCapacity();
+    monitor_index.y_edges.clearRetainingCapacity();
+
+    var current = monitors;
+    while (current) |monitor| : (current = monitor.next) {
+        try monitor_index.x_edges.appendSlice(allocator, &.{ monitor.win_x, monitor.win_x + monitor.win_w });
+        try monitor_index.y_edges.appendSlice(allocator, &.{ monitor.win_y, monitor.win_y + monitor.win_h });
+    }
+    sort_unique(&monitor_index.x_edges);
+    sort_unique(&monitor_index.y_edges);
+
+    const columns = if (monitor_index.x_edges.items.len > 1) monitor_index.x_edges.items.len - 1 else 0;
+    const rows = if (monitor_index.y_edges.items.len > 1) monitor_index.y_edges.items.len - 1 else 0;
+    try monitor_index.cells.resize(allocator, columns * rows);
+
+    for (0..rows) |row| {
+        for (0..columns) |column| {
+            monitor_index.cells.items[row * columns + column] = monitor_at(monitor_index.x_edges.items[column], monitor_index.y_edges.items[row]);
+        }
+    }
+    monitor_index.dirty = false;
+}
+
+fn monitor_at(x: i32, y: i32) ?*Monitor {
+    var current = monitors;
+    while (current) |monitor| : (current = monitor.next) {
+        if (x >= monitor.win_x and x < monitor.win_x + monitor.win_w and y >= monitor.win_y and y < monitor.win_y + monitor.win_h) {
+            return monitor;
+        }
+    }
+    return null;
+}
+
+fn sort_unique(edges: *std.ArrayListUnmanaged(i32)) void {
+    std.mem.sort(i32, edges.items, {}, std.sort.asc(i32));
+    var len: usize = 0;
+    for (edges.items) |edge| {
+        if (len > 0 and edges.items[len - 1] == edge) continue;
+        edges.items[len] = edge;
+        len += 1;
+    }
+    edges.shrinkRetainingCapacity(len);
+}
+
+fn find_span(edges: []const i32, value: i32) ?usize {
+    if (edges.len < 2 or value < edges[0] or value >= edges[edges.len - 1]) return null;
+    var low: usize = 0;
+    var high: usize = edges.len - 1;
+    while (high - low > 1) {
+        const middle = low + (high - low) / 2;
+        if (edges[middle] <= value) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
 pub fn dir_to_monitor(direction: i32) ?*Monitor {
     var target: ?*Monitor = null;
 
@@ -0,0 +1,220 @@
+const std = @import("std");
+const xlib = @import("x11/xlib.zig");
+const client_mod = @import("client.zig");
+
+const Client = client_mod.Client;
+
+pub const title: u8 = 1 << 0;
+pub const size_hints: u8 = 1 << 1;
+pub const wm_hints: u8 = 1 << 2;
+pub const window_type: u8 = 1 << 3;
+pub const class: u8 = 1 << 4;
+pub const all: u8 = title | size_hints | wm_hints | window_type | class;
+pub const deferred: u8 = wm_hints | window_type;
+
+var display_handle: ?*xlib.Display = null;
+var net_wm_name: xlib.Atom = 0;
+var pending: bool = false;
+
+pub fn init(display: *xlib.Display, wm_name_atom: xlib.Atom) void {
+    display_handle = display;
+    net_wm_name = wm_name_atom;
+}
+
+pub fn mark(client: *Client, bits: u8) void {
+    client.dirty |= bits;
+    if ((bits & deferred) != 0) {
+        pending = true;
+    }
+}
+
+pub fn take_pending() bool {
+    const was_pending = pending;
+    pending = false;
+    return was_pending;
+}
+
+pub fn take(client: *Client, bit: u8) bool {
+    if ((client.dirty & bit) == 0) return false;
+    client.dirty &= ~bit;
+    return true;
+}
+
+pub fn get_title(client: *Client) []const u8 {
+    if (take(client, title)) {
+        fetch_title(client);
+    }
+    return client_mod.get_title(client);
+}
+
+pub fn get_class(client: *Client) []const u8 {
+    ensure_class(client);
+    return client_mod.get_class(client);
+}
+
+pub fn get_instance(client: *Client) []const u8 {
+    ensure_class(client);
+    return client_mod.get_instance(client);
+}
+
+pub fn ensure_size_hints(client: *Client) void {
+    if (!take(client, size_hints)) return;
+    const display = display_handle orelse return;
+
+    var hints: xlib.XSizeHints = undefined;
+    var msize: c_long = 0;
+
+    if (xlib.XGetWMNormalHints(display, client.window, &hints, &msize) == 0) {
+        hints.flags = xlib.PSize;
+    }
+    store_size_hints(client, &hints);
+}
+
+pub fn seed_size_hints(client: *Client, words: []align(1) const u32) void {
+    var hints = std.mem.zeroes(xlib.XSizeHints);
+    if (words.len < 15) {
+        hints.flags = xlib.PSize;
+    } else {
+        hints.flags = words[0];
+        hints.min_width = @bitCast(words[5]);
+        hints.min_height = @bitCast(words[6]);
+        hints.max_width = @bitCast(words[7]);
+        hints.max_height = @bitCast(words[8]);
+        hints.width_inc = @bitCast(words[9]);
+        hints.height_inc = @bitCast(words[10]);
+        hints.min_aspect = .{ .x = @bitCast(words[11]), .y = @bitCast(words[12]) };
+        hints.max_aspect = .{ .x = @bitCast(words[13]), .y = @bitCast(words[14]) };
+        if (words.len >= 18) {
+            hints.base_width = @bitCast(words[15]);
+            hints.base_height = @bitCast(words[16]);
+        } else {
+            hints.flags &= ~@as(c_long, xlib.PBaseSize);
+        }
+    }
+    store_size_hints(client, &hints);
+    client.dirty &= ~size_hints;
+}
+
+pub fn seed_class(client: *Client, value: []const u8) void {
+    const instance_end = std.mem.indexOfScalar(u8, value, 0) orelse value.len;
+    const rest = value[@min(instance_end + 1, value.len)..];
+    const class_end = std.mem.indexOfScalar(u8, rest, 0) orelse rest.len;
+    client_mod.set_class(client, value[0..instance_end], rest[0..class_end]);
+    client.dirty &= ~class;
+}
+
+pub fn seed_title(client: *Client, text: []const u8) void {
+    const end = std.mem.indexOfScalar(u8, text, 0) orelse text.len;
+    client_mod.set_title(client, if (end == 0) "broken" else text[0..@min(end, 255)]);
+    client.dirty &= ~title;
+}
+
+fn store_size_hints(client: *Client, hints: *const xlib.XSizeHints) void {
+    if ((hints.flags & xlib.PBaseSize) != 0) {
+        client.base_width = hints.base_width;
+        client.base_height = hints.base_height;
+    } else if ((hints.flags & xlib.PMinSize) != 0) {
+        client.base_width = hints.min_width;
+        client.base_height = hints.min_height;
+    } else {
+        client.base_width = 0;
+        client.base_height = 0;
+    }
+
+    if ((hints.flags & xlib.PResizeInc) != 0) {
+        client.increment_width = hints.width_inc;
+        client.increment_height = hints.height_inc;
+    } else {
+        client.increment_width = 0;
+        client.increment_height = 0;
+    }
+
+    if ((hints.flags & xlib.PMaxSize) != 0) {
+        client.max_width = hints.max_width;
+        client.max_height = hints.max_height;
+    } else {
+        client.max_width = 0;
+        client.max_height = 0;
+    }
+
+    if ((hints.flags & xlib.PMinSize) != 0) {
+        client.min_width = hints.min_width;
+        client.min_height = hints.min_height;
+    } else if ((hints.flags & xlib.PBaseSize) != 0) {
+        client.min_width = hints.base_width;
+        client.min_height = hints.base_height;
+    } else {
+        client.min_width = 0;
+        client.min_height = 0;
+    }
+
+    if ((hints.flags & xlib.PAspect) != 0) {
+        client.min_aspect = @as(f32, @floatFromInt(hints.min_aspect.y)) / @as(f32, @floatFromInt(hints.min_aspect.x));
+        client.max_aspect = @as(f32, @floatFromInt(hints.max_aspect.x)) / @as(f32, @floatFromInt(hints.max_aspect.y));
+    } else {
+        client.min_aspect = 0.0;
+        client.max_aspect = 0.0;
+    }
+
+    client.is_fixed = (client.max_width != 0 and client.max_height != 0 and client.max_width == client.min_width and client.max_height == client.min_height);
+}
+
+fn ensure_class(client: *Client) void {
+    if (!take(client, class)) return;
+    const display = display_handle orelse return;
+
+    var class_hint: xlib.XClassHint = .{ .res_name = null, .res_class = null };
+    if (xlib.XGetClassHint(display, client.window, &class_hint) == 0) {
+        client_mod.set_class(client, "", "");
+        return;
+    }
+
+    const instance_str: []const u8 = if (class_hint.res_name) |ptr| std.mem.sliceTo(ptr, 0) else "";
+    const class_str: []const u8 = if (class_hint.res_class) |ptr| std.mem.sliceTo(ptr, 0) else "";
+    client_mod.set_class(client, instance_str, class_str);
+
+    if (class_hint.res_class) |ptr| {
+        _ = xlib.XFree(@ptrCast(ptr));
+    }
+    if (class_hint.res_name) |ptr| {
+        _ = xlib.XFree(@ptrCast(ptr));
+    }
+}
+
+fn fetch_title(client: *Client) void {
+    const display = display_handle orelse return;
+    var text: [256]u8 = undefined;
+    if (!get_text_prop(display, client.window, net_wm_name, &text)) {
+        _ = get_text_prop(display, client.window, xlib.XA_WM_NAME, &text);
+    }
+    const title = std.mem.sliceTo(&text, 0);
+    client_mod.set_title(client, if (title.len == 0) "broken" else title);
+}
+
+fn get_text_prop(display: *xlib.Display, window: xlib.Window, atom: xlib.Atom, text: *[256]u8) bool {
+    var name: xlib.XTextProperty = undefined;
+    text[0] = 0;
+
+    if (xlib.XGetTextProperty(display, window, &name, atom) == 0 or name.nitems == 0) {
+        return false;
+    }
+
+    if (name.encoding == xlib.XA_STRING) {
+        const len = @min(name.nitems, 255);
+        @memcpy(text[0..len], name.value[0..len]);
+        text[len] = 0;
+    } else {
+        var list: [*c][*c]u8 = undefined;
+        var count: c_int = undefined;
+        if (xlib.XmbTextPropertyToTextList(display, &name, &list, &count) >= xlib.Success and count > 0 and list[0] != null) {
+            const str = std.mem.sliceTo(list[0], 0);
+            const copy_len = @min(str.len, 255);
+            @memcpy(text[0..copy_len], str[0..copy_len]);
+            text[copy_len] = 0;
+            xlib.XFreeStringList(list);
+        }
+    }
+    text[255] = 0;
+    _ = xlib.XFree(@ptrCast(name.value));
+    return true;
+}
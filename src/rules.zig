@@ -0,0 +1,336 @@
+const std = @import("std");
+
+pub const Rule = struct {
+    class: ?[]const u8,
+    instance: ?[]const u8,
+    title: ?[]const u8,
+    tags: u32,
+    is_floating: bool,
+    monitor: i32,
+};
+
+pub const Outcome = struct {
+    tags: u32 = 0,
+    is_floating: bool = false,
+    monitor: i32 = -1,
+};
+
+const need_class: u8 = 1 << 0;
+const need_instance: u8 = 1 << 1;
+const need_title: u8 = 1 << 2;
+
+const class_cache_capacity = 256;
+const no_rule = std.math.maxInt(u32);
+
+fn targets_monitor(rule: Rule, monitor_count: usize) bool {
+    return rule.monitor >= 0 and @as(usize, @intCast(rule.monitor)) < monitor_count;
+}
+
+pub fn match_linear(rules: []const Rule, class: []const u8, instance: []const u8, title: []const u8, monitor_count: usize) Outcome {
+    var outcome = Outcome{};
+    for (rules) |rule| {
+        const class_matches = if (rule.class) |pattern| std.mem.indexOf(u8, class, pattern) != null else true;
+        const instance_matches = if (rule.instance) |pattern| std.mem.indexOf(u8, instance, pattern) != null else true;
+        const title_matches = if (rule.title) |pattern| std.mem.indexOf(u8, title, pattern) != null else true;
+
+        if (class_matches and instance_matches and title_matches) {
+            outcome.is_floating = rule.is_floating;
+            outcome.tags |= rule.tags;
+            if (targets_monitor(rule, monitor_count)) {
+                outcome.monitor = rule.monitor;
+            }
+        }
+    }
+    return outcome;
+}
+
+pub fn uses_title(rules: []const Rule) bool {
+    for (rules) |rule| {
+        if (non_empty(rule.title) != null) return true;
+    }
+    return false;
+}
+
+const Node = struct {
+    fail: u32 = 0,
+    dict: u32 = 0,
+    pattern: u32 = 0,
+    first_child: u32 = 0,
+    next_sibling: u32 = 0,
+    byte: u8 = 0,
+};
+
+const Automaton = struct {
+    nodes: std.ArrayListUnmanaged(Node) = .{},
+    edges: std.AutoHashMapUnmanaged(u64, u32) = .{},
+    targets: std.ArrayListUnmanaged(std.ArrayListUnmanaged(u32)) = .{},
+
+    fn deinit(self: *Automaton, allocator: std.mem.Allocator) void {
+        for (self.targets.items) |*target| target.deinit(allocator);
+        self.targets.deinit(allocator);
+        self.edges.deinit(allocator);
+        self.nodes.deinit(allocator);
+    }
+
+    fn edge(self: *const Automaton, state: u32, byte: u8) ?u32 {
+        return self.edges.get((@as(u64, state) << 8) | byte);
+    }
+
+    fn insert(self: *Automaton, allocator: std.mem.Allocator, pattern: []const u8, rule_index: u32) !void {
+        if (self.nodes.items.len == 0) try self.nodes.append(allocator, .{});
+
+        var state: u32 = 0;
+        for (pattern) |byte| {
+            if (self.edge(state, byte)) |next| {
+                state = next;
+                continue;
+            }
+            const child: u32 = @intCast(self.nodes.items.len);
+            try self.nodes.append(allocator, .{ .byte = byte, .next_sibling = self.nodes.items[state].first_child });
+            self.nodes.items[state].first_child = child;
+            try self.edges.put(allocator, (@as(u64, state) << 8) | byte, child);
+            state = child;
+        }
+
+        const node = &self.nodes.items[state];
+        if (node.pattern == 0) {
+            try self.targets.append(allocator, .{});
+            node.pattern = @intCast(self.targets.items.len);
+        }
+        try self.targets.items[node.pattern - 1].append(allocator, rule_index);
+    }
+
+    fn finish(self: *Automaton, allocator: std.mem.Allocator) !void {
+        if (self.nodes.items.len == 0) return;
+
+        var queue: std.ArrayListUnmanaged(u32) = .{};
+        defer queue.deinit(allocator);
+        try queue.ensureTotalCapacity(allocator, self.nodes.items.len);
+
+        var child = self.nodes.items[0].first_child;
+        while (child != 0) : (child = self.nodes.items[child].next_sibling) {
+            queue.appendAssumeCapacity(child);
+        }
+
+        var head: usize = 0;
+        while (head < queue.items.len) : (head += 1) {
+            const parent = queue.items[head];
+            child = self.nodes.items[parent].first_child;
+            while (child != 0) : (child = self.nodes.items[child].next_sibling) {
+                const byte = self.nodes.items[child].byte;
+                var fallback = self.nodes.items[parent].fail;
+                while (fallback != 0 and self.edge(fallback, byte) == null) {
+                    fallback = self.nodes.items[fallback].fail;
+                }
+                const fail = self.edge(fallback, byte) orelse 0;
+                const fail_node = self.nodes.items[fail];
+                self.nodes.items[child].fail = fail;
+                self.nodes.items[child].dict = if (fail_node.pattern != 0) fail else fail_node.dict;
+                queue.appendAssumeCapacity(child);
+            }
+        }
+    }
+
+    fn search(self: *const Automaton, text: []const u8, context: anytype, comptime report: fn (@TypeOf(context), []const u32) void) void {
+        if (self.nodes.items.len == 0) return;
+
+        var state: u32 = 0;
+        for (text) |byte| {
+            while (state != 0 and self.edge(state, byte) == null) {
+                state = self.nodes.items[state].fail;
+            }
+            state = self.edge(state, byte) orelse 0;
+
+            var output = if (self.nodes.items[state].pattern != 0) state else self.nodes.items[state].dict;
+            while (output != 0) : (output = self.nodes.items[output].dict) {
+                report(context, self.targets.items[self.nodes.items[output].pattern - 1].items);
+            }
+        }
+    }
+};
+
+const Partial = struct {
+    tags: u32 = 0,
+    floating_rule: u32 = no_rule,
+    monitor_rule: u32 = no_rule,
+
+    fn add(self: *Partial, rules: []const Rule, index: u32, monitor_count: usize) void {
+        const rule = rules[index];
+        self.tags |= rule.tags;
+        if (self.floating_rule == no_rule or index > self.floating_rule) self.floating_rule = index;
+        if (targets_monitor(rule, monitor_count) and (self.monitor_rule == no_rule or index > self.monitor_rule)) self.monitor_rule = index;
+    }
+};
+
+pub const Matcher = struct {
+    allocator: std.mem.Allocator,
+    rules: []const Rule,
+    needs: []u8,
+    satisfied: []u8,
+    touched: std.ArrayListUnmanaged(u32) = .{},
+    unconditional: Partial = .{},
+    unconditional_monitor_rules: std.ArrayListUnmanaged(u32) = .{},
+    class: Automaton = .{},
+    instance: Automaton = .{},
+    title: Automaton = .{},
+    class_cache: std.StringHashMapUnmanaged([]const u32) = .{},
+    scratch: std.ArrayListUnmanaged(u32) = .{},
+
+    pub fn init(allocator: std.mem.Allocator, rules: []const Rule) !Matcher {
+        var self = Matcher{
+            .allocator = allocator,
+            .rules = rules,
+            .needs = try allocator.alloc(u8, rules.len),
+            .satisfied = &.{},
+        };
+        errdefer self.deinit();
+        self.satisfied = try allocator.alloc(u8, rules.len);
+        @memset(self.satisfied, 0);
+
+        for (rules, 0..) |rule, rule_index| {
+            const index: u32 = @intCast(rule_index);
+            var needs: u8 = 0;
+            if (non_empty(rule.class)) |pattern| {
+                needs |= need_class;
+                try self.class.insert(allocator, pattern, index);
+            }
+            if (non_empty(rule.instance)) |pattern| {
+                needs |= need_instance;
+                try self.instance.insert(allocator, pattern, index);
+            }
+            if (non_empty(rule.title)) |pattern| {
+                needs |= need_title;
+                try self.title.insert(allocator, pattern, index);
+            }
+            self.needs[rule_index] = needs;
+            if (needs == 0) {
+                self.unconditional.add(rules, index, 0);
+                if (rule.monitor >= 0) try self.unconditional_monitor_rules.append(allocator, index);
+            }
+        }
+
+        try self.class.finish(allocator);
+        try self.instance.finish(allocator);
+        try self.title.finish(allocator);
+        try self.touched.ensureTotalCapacity(allocator, rules.len);
+        return self;
+    }
+
+    pub fn deinit(self: *Matcher) void {
+        self.clear_class_cache();
+        self.class_cache.deinit(self.allocator);
+        self.scratch.deinit(self.allocator);
+        self.touched.deinit(self.allocator);
+        self.unconditional_monitor_rules.deinit(self.allocator);
+        self.class.deinit(self.allocator);
+        self.instance.deinit(self.allocator);
+        self.title.deinit(self.allocator);
+        self.allocator.free(self.satisfied);
+        self.allocator.free(self.needs);
+    }
+
+    pub fn match(self: *Matcher, class: []const u8, instance: []const u8, title: []const u8, monitor_count: usize) Outcome {
+        for (self.class_rules(class)) |index| self.satisfy(index, need_class);
+        self.instance.search(instance, Satisfy_Context{ .matcher = self, .bit = need_instance }, Satisfy_Context.report);
+        self.title.search(title, Satisfy_Context{ .matcher = self, .bit = need_title }, Satisfy_Context.report);
+
+        var partial = self.unconditional;
+        var remaining = self.unconditional_monitor_rules.items.len;
+        while (remaining > 0) {
+            remaining -= 1;
+            const index = self.unconditional_monitor_rules.items[remaining];
+            if (targets_monitor(self.rules[index], monitor_count)) {
+                partial.monitor_rule = index;
+                break;
+            }
+        }
+        for (self.touched.items) |index| {
+            if (self.satisfied[index] == self.needs[index]) partial.add(self.rules, index, monitor_count);
+            self.satisfied[index] = 0;
+        }
+        self.touched.clearRetainingCapacity();
+
+        var outcome = Outcome{ .tags = partial.tags };
+        if (partial.floating_rule != no_rule) outcome.is_floating = self.rules[partial.floating_rule].is_floating;
+        if (partial.monitor_rule != no_rule) outcome.monitor = self.rules[partial.monitor_rule].monitor;
+        return outcome;
+    }
+
+    pub fn uses_title(self: *const Matcher) bool {
+        return self.title.nodes.items.len > 0;
+    }
+
+    fn satisfy(self: *Matcher, index: u32, bit: u8) void {
+        if (self.satisfied[index] == 0) self.touched.appendAssumeCapacity(index);
+        self.satisfied[index] |= bit;
+    }
+
+    fn class_rules(self: *Matcher, class: []const u8) []const u32 {
+        if (self.class_cache.get(class)) |cached| return cached;
+
+        self.scratch.clearRetainingCapacity();
+        self.class.search(class, self, collect_class_rule);
+
+        if (self.class_cache.count() >= class_cache_capacity) self.clear_class_cache();
+        const key = self.allocator.dupe(u8, class) catch return self.scratch.items;
+        const value = self.allocator.dupe(u32, self.scratch.items) catch {
+            self.allocator.free(key);
+            return self.scratch.items;
+        };
+        self.class_cache.put(self.allocator, key, value) catch {
+            self.allocator.free(key);
+            self.allocator.free(value);
+            return self.scratch.items;
+        };
+        return value;
+    }
+
+    fn collect_class_rule(self: *Matcher, targets: []const u32) void {
+        self.scratch.appendSlice(self.allocator, targets) catch {};
+    }
+
+    fn clear_class_cache(self: *Matcher) void {
+        var iterator = self.class_cache.iterator();
+        while (iterator.next()) |entry| {
+            self.allocator.free(entry.key_ptr.*);
+            self.allocator.free(entry.value_ptr.*);
+        }
+        self.class_cache.clearRetainingCapacity();
+    }
+};
+
+const Satisfy_Context = struct {
+    matcher: *Matcher,
+    bit: u8,
+
+    fn report(self: Satisfy_Context, targets: []const u32) void {
+        for (targets) |index| self.matcher.satisfy(index, self.bit);
+    }
+};
+
+fn non_empty(pattern: ?[]const u8) ?[]const u8 {
+    const text = pattern orelse return null;
+    return if (text.len == 0) null else text;
+}
+
+test "a rule naming a missing monitor keeps the earlier valid assignment" {
+    const rule_set = [_]Rule{
+        .{ .class = null, .instance = null, .title = null, .tags = 0, .is_floating = false, .monitor = 1 },
+        .{ .class = "Firefox", .instance = null, .title = null, .tags = 0, .is_floating = false, .monitor = 0 },
+        .{ .class = "Firefox", .instance = null, .title = null, .tags = 0, .is_floating = false, .monitor = 3 },
+        .{ .class = null, .instance = null, .title = null, .tags = 0, .is_floating = false, .monitor = 5 },
+    };
+    var matcher = try Matcher.init(std.testing.allocator, &rule_set);
+    defer matcher.deinit();
+
+    for ([_]usize{ 1, 2, 4, 6 }) |monitor_count| {
+        const expected = match_linear(&rule_set, "Firefox", "", "", monitor_count);
+        try std.testing.expectEqual(expected, matcher.match("Firefox", "", "", monitor_count));
+        const other = match_linear(&rule_set, "St", "", "", monitor_count);
+        try std.testing.expectEqual(other, matcher.match("St", "", "", monitor_count));
+    }
+    try std.testing.expectEqual(@as(i32, 0), matcher.match("Firefox", "", "", 2).monitor);
+    try std.testing.expectEqual(@as(i32, 3), matcher.match("Firefox", "", "", 4).monitor);
+    try std.testing.expectEqual(@as(i32, 1), matcher.match("St", "", "", 2).monitor);
+    try std.testing.expectEqual(@as(i32, -1), matcher.match("St", "", "", 1).monitor);
+}
@@ -0,0 +1,140 @@
+const std = @import("std");
+
+pub fn Slab(comptime T: type, comptime items_per_page: usize) type {
+    return struct {
+        const Self = @This();
+
+        const Slot = struct {
+            item: T,
+            next: ?*Slot,
+        };
+
+        const Page = [items_per_page]Slot;
+
+        pages: std.ArrayListUnmanaged(*Page) = .{},
+        free: ?*Slot = null,
+        live: usize = 0,
+        peak: usize = 0,
+
+        pub fn create(self: *Self, allocator: std.mem.Allocator) !*T {
+            if (self.free == null) try self.grow(allocator);
+            const slot = self.free.?;
+            self.free = slot.next;
+            self.live += 1;
+            self.peak = @max(self.peak, self.live);
+            return &slot.item;
+        }
+
+        pub fn destroy(self: *Self, item: *T) void {
+            const slot: *Slot = @fieldParentPtr("item", item);
+            slot.next = self.free;
+            self.free = slot;
+            self.live -= 1;
+        }
+
+        pub fn deinit(self: *Self, allocator: std.mem.Allocator) void {
+            for (self.pages.items) |page| allocator.destroy(page);
+            self.pages.deinit(allocator);
+            self.* = .{};
+        }
+
+        pub fn capacity(self: *const Self) usize {
+            return self.pages.items.len * items_per_page;
+        }
+
+        pub fn bytes(self: *const Self) usize {
+            return self.pages.items.len * @sizeOf(Page) + self.pages.capacity * @sizeOf(*Page);
+        }
+
+        fn grow(self: *Self, allocator: std.mem.Allocator) !void {
+            const page = try allocator.create(Page);
+            errdefer allocator.destroy(page);
+            try self.pages.append(allocator, page);
+
+            var index = items_per_page;
+            while (index > 0) {
+                index -= 1;
+                page[index].next = self.free;
+                self.free = &page[index];
+            }
+        }
+    };
+}
+
+pub const Text_Pool = struct {
+    const class_sizes = [_]usize{ 16, 32, 64, 128, 256 };
+    const page_size = 4096;
+
+    const Chunk = struct {
+        next: ?*Chunk,
+    };
+
+    pages: std.ArrayListUnmanaged([]align(@alignOf(Chunk)) u8) = .{},
+    free: [class_sizes.len]?*Chunk = [_]?*Chunk{null} ** class_sizes.len,
+    used: [class_sizes.len]usize = [_]usize{0} ** class_sizes.len,
+
+    pub const max_len = class_sizes[class_sizes.len - 1];
+
+    pub fn acquire(self: *Text_Pool, allocator: std.mem.Allocator, len: usize) ?[]u8 {
+        const class = class_of(len) orelse return null;
+        if (self.free[class] == null) self.grow(allocator, class) catch return null;
+        const chunk = self.free[class].?;
+        self.free[class] = chunk.next;
+        self.used[class] += 1;
+        const memory: [*]u8 = @ptrCast(chunk);
+        return memory[0..class_sizes[class]];
+    }
+
+    pub fn release(self: *Text_Pool, memory: []u8) void {
+        if (memory.len == 0) return;
+        const class = class_of(memory.len) orelse return;
+        const chunk: *Chunk = @ptrCast(@alignCast(memory.ptr));
+        chunk.next = self.free[class];
+        self.free[class] = chunk;
+        self.used[class] -= 1;
+    }
+
+    pub fn deinit(self: *Text_Pool, allocator: std.mem.Allocator) void {
+        for (self.pages.items) |page| allocator.free(page);
+        self.pages.deinit(allocator);
+        self.* = .{};
+    }
+
+    pub fn bytes(self: *const Text_Pool) usize {
+        return self.pages.items.len * page_size + self.pages.capacity * @sizeOf([]u8);
+    }
+
+    pub fn used_bytes(self: *const Text_Pool) usize {
+        var total: usize = 0;
+        for (self.used, class_sizes) |count, size| total += count * size;
+        return total;
+    }
+
+    pub fn chunks_in_use(self: *const Text_Pool) usize {
+        var total: usize = 0;
+        for (self.used) |count| total += count;
+        return total;
+    }
+
+    fn class_of(len: usize) ?usize {
+        for (class_sizes, 0..) |size, class| {
+            if (len <= size) return class;
+        }
+        return null;
+    }
+
+    fn grow(self: *Text_Pool, allocator: std.mem.Allocator, class: usize) !void {
+        const page = try allocator.alignedAlloc(u8, .of(Chunk), page_size);
+        errdefer allocator.free(page);
+        try self.pages.append(allocator, page);
+
+        const size = class_sizes[class];
+        var offset: usize = page_size;
+        while (offset >= size) {
+            offset -= size;
+            const chunk: *Chunk = @ptrCast(@alignCast(&page[offset]));
+            chunk.next = self.free[class];
+            self.free[class] = chunk;
+        }
+    }
+};
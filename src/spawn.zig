@@ -0,0 +1,283 @@
+const std = @import("std");
+const log = @import("log.zig");
+
+const c = @cImport({
+    @cDefine("_GNU_SOURCE", "1");
+    @cInclude("fcntl.h");
+    @cInclude("spawn.h");
+    @cInclude("signal.h");
+    @cInclude("sys/signalfd.h");
+    @cInclude("sys/wait.h");
+});
+
+const shell_metacharacters = "|&;<>()$`\\\"'*?[]#~{}!%\n";
+
+pub const Command = struct {
+    argv: [:null]?[*:0]const u8,
+    storage: [:0]u8,
+    uses_shell: bool,
+};
+
+var allocator: std.mem.Allocator = undefined;
+var prepared: std.ArrayListUnmanaged(*Command) = .{};
+var signal_fd: ?std.posix.fd_t = null;
+var child_mask: c.sigset_t = undefined;
+var empty_mask: c.sigset_t = undefined;
+var enabled: bool = true;
+
+pub fn init(alloc: std.mem.Allocator) void {
+    allocator = alloc;
+    _ = c.sigemptyset(&empty_mask);
+    _ = c.sigemptyset(&child_mask);
+    _ = c.sigaddset(&child_mask, c.SIGCHLD);
+
+    if (c.sigprocmask(c.SIG_BLOCK, &child_mask, null) != 0) return;
+    const fd = c.signalfd(-1, &child_mask, c.SFD_NONBLOCK | c.SFD_CLOEXEC);
+    if (fd < 0) {
+        _ = c.sigprocmask(c.SIG_UNBLOCK, &child_mask, null);
+        log.warn(.core, "signalfd unavailable, children will not be reaped", .{});
+        return;
+    }
+    signal_fd = fd;
+}
+
+pub fn deinit() void {
+    release_prepared();
+    prepared.deinit(allocator);
+    if (signal_fd) |fd| {
+        std.posix.close(fd);
+        signal_fd = null;
+    }
+}
+
+pub fn get_fd() ?std.posix.fd_t {
+    return signal_fd;
+}
+
+pub fn reap() void {
+    const fd = signal_fd orelse return;
+    var buffer: [8 * @sizeOf(c.struct_signalfd_siginfo)]u8 align(8) = undefined;
+    while (true) {
+        const len = std.posix.read(fd, &buffer) catch break;
+        if (len == 0) break;
+    }
+    while (c.waitpid(-1, null, c.WNOHANG) > 0) {}
+}
+
+pub fn needs_shell(text: []const u8) bool {
+    if (std.mem.indexOfAny(u8, text, shell_metacharacters) != null) return true;
+    var words = std.mem.tokenizeAny(u8, text, " \t");
+    const program = words.next() orelse return false;
+    return std.mem.indexOfScalar(u8, program, '=') != null;
+}
+
+pub fn parse(text: []const u8) !Command {
+    const trimmed = std.mem.trim(u8, text, " \t\n");
+    if (trimmed.len == 0) return error.EmptyCommand;
+
+    const storage = try allocator.allocSentinel(u8, trimmed.len, 0);
+    errdefer allocator.free(storage);
+
+    if (needs_shell(trimmed)) {
+        @memcpy(storage, trimmed);
+        const argv = try allocator.allocSentinel(?[*:0]const u8, 3, null);
+        argv[0] = "/bin/sh";
+        argv[1] = "-c";
+        argv[2] = storage.ptr;
+        return .{ .argv = argv, .storage = storage, .uses_shell = true };
+    }
+
+    var count: usize = 0;
+    var words = std.mem.tokenizeAny(u8, trimmed, " \t");
+    while (words.next()) |_| count += 1;
+
+    const argv = try allocator.allocSentinel(?[*:0]const u8, count, null);
+    var offset: usize = 0;
+    var index: usize = 0;
+    words.reset();
+    while (words.next()) |word| : (index += 1) {
+        @memcpy(storage[offset..][0..word.len], word);
+        storage[offset + word.len] = 0;
+        argv[index] = @ptrCast(storage[offset..].ptr);
+        offset += word.len + 1;
+    }
+    return .{ .argv = argv, .storage = storage, .uses_shell = false };
+}
+
+pub fn prepare(text: []const u8) ?*const Command {
+    const command = allocator.create(Command) catch return null;
+    command.* = parse(text) catch {
+        allocator.destroy(command);
+        return null;
+    };
+    prepared.append(allocator, command) catch {
+        free(command);
+        return null;
+    };
+    return command;
+}
+
+pub fn release_prepared() void {
+    for (prepared.items) |command| {
+        free(command);
+    }
+    prepared.clearRetainingCapacity();
+}
+
+fn free(command: *Command) void {
+    allocator.free(command.argv);
+    allocator.free(command.storage);
+    allocator.destroy(command);
+}
+
+pub fn run_text(text: []const u8) void {
+    var command = parse(text) catch return;
+    defer {
+        allocator.free(command.argv);
+        allocator.free(command.storage);
+    }
+    run(&command);
+}
+
+pub fn disable() void {
+    enabled = false;
+}
+
+fn init_attr(attr: *c.posix_spawnattr_t, flags: c_int) bool {
+    if (c.posix_spawnattr_init(attr) != 0) return false;
+    _ = c.posix_spawnattr_setsigmask(attr, &empty_mask);
+    _ = c.posix_spawnattr_setsigdefault(attr, &child_mask);
+    _ = c.posix_spawnattr_setflags(attr, @intCast(flags | c.POSIX_SPAWN_SETSIGMASK | c.POSIX_SPAWN_SETSIGDEF));
+    return true;
+}
+
+pub fn run(command: *const Command) void {
+    if (!enabled) return;
+    var attr: c.posix_spawnattr_t = undefined;
+    if (!init_attr(&attr, c.POSIX_SPAWN_SETSID)) return;
+    defer _ = c.posix_spawnattr_destroy(&attr);
+
+    var pid: c.pid_t = 0;
+    const program = command.argv[0] orelse return;
+    const result = c.posix_spawnp(&pid, program, null, &attr, @ptrCast(command.argv.ptr), @ptrCast(std.c.environ));
+    if (result != 0) {
+        log.warn(.core, "spawn {s} failed: errno {d}", .{ std.mem.span(program), result });
+        return;
+    }
+    log.debug(.core, "spawned {s} pid={d} shell={}", .{ std.mem.span(program), pid, command.uses_shell });
+}
+
+pub fn capture(script: []const u8, output: []u8) ?[]u8 {
+    const script_z = allocator.dupeZ(u8, script) catch return null;
+    defer allocator.free(script_z);
+    const argv = [_:null]?[*:0]const u8{ "/bin/sh", "-c", script_z.ptr };
+
+    const pipe = std.posix.pipe2(.{ .CLOEXEC = true }) catch return null;
+    defer std.posix.close(pipe[0]);
+
+    var actions: c.posix_spawn_file_actions_t = undefined;
+    if (c.posix_spawn_file_actions_init(&actions) != 0) {
+        std.posix.close(pipe[1]);
+        return null;
+    }
+    defer _ = c.posix_spawn_file_actions_destroy(&actions);
+    _ = c.posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", c.O_RDONLY, 0);
+    _ = c.posix_spawn_file_actions_adddup2(&actions, pipe[1], 1);
+    _ = c.posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", c.O_WRONLY, 0);
+
+    var attr: c.posix_spawnattr_t = undefined;
+    if (!init_attr(&attr, 0)) {
+        std.posix.close(pipe[1]);
+        return null;
+    }
+    defer _ = c.posix_spawnattr_destroy(&attr);
+
+    var pid: c.pid_t = 0;
+    const result = c.posix_spawn(&pid, argv[0].?, &actions, &attr, @ptrCast(&argv), @ptrCast(std.c.environ));
+    std.posix.close(pipe[1]);
+    if (result != 0) {
+        log.warn(.core, "spawn /bin/sh failed: errno {d}", .{result});
+        return null;
+    }
+
+    var len: usize = 0;
+    while (true) {
+        if (len == output.len) {
+            var discard: [256]u8 = undefined;
+            const drained = std.posix.read(pipe[0], &discard) catch break;
+            if (drained == 0) break;
+            continue;
+        }
+        const received = std.posix.read(pipe[0], output[len..]) catch break;
+        if (received == 0) break;
+        len += received;
+    }
+    _ = c.waitpid(pid, null, 0);
+    return output[0..len];
+}
+
+test "parse splits plain commands into argv without a shell" {
+    allocator = std.testing.allocator;
+    const command = try parse("  st -e\thtop --sort-key=PERCENT_CPU \n");
+    defer {
+        allocator.free(command.argv);
+        allocator.free(command.storage);
+    }
+    try std.testing.expect(!command.uses_shell);
+    try std.testing.expectEqual(@as(usize, 4), command.argv.len);
+    try std.testing.expectEqualStrings("st", std.mem.span(command.argv[0].?));
+    try std.testing.expectEqualStrings("-e", std.mem.span(command.argv[1].?));
+    try std.testing.expectEqualStrings("htop", std.mem.span(command.argv[2].?));
+    try std.testing.expectEqualStrings("--sort-key=PERCENT_CPU", std.mem.span(command.argv[3].?));
+    try std.testing.expect(command.argv[4] == null);
+}
+
+test "parse falls back to /bin/sh for quoting, escapes and metacharacters" {
+    allocator = std.testing.allocator;
+    const shell_commands = [_][]const u8{
+        "notify-send 'hello world'",
+        "notify-send \"hello world\"",
+        "touch a\\ b",
+        "maim -s | xclip -selection clipboard",
+        "sleep 1; slock",
+        "firefox &",
+        "echo $HOME",
+        "ls ~/Pictures",
+        "rm *.tmp",
+        "GDK_SCALE=2 firefox",
+    };
+    for (shell_commands) |text| {
+        try std.testing.expect(needs_shell(text));
+        const command = try parse(text);
+        defer {
+            allocator.free(command.argv);
+            allocator.free(command.storage);
+        }
+        try std.testing.expect(command.uses_shell);
+        try std.testing.expectEqual(@as(usize, 3), command.argv.len);
+        try std.testing.expectEqualStrings("/bin/sh", std.mem.span(command.argv[0].?));
+        try std.testing.expectEqualStrings("-c", std.mem.span(command.argv[1].?));
+        try std.testing.expectEqualStrings(text, std.mem.span(command.argv[2].?));
+    }
+    try std.testing.expect(!needs_shell("dmenu_run -fn monospace:size=10"));
+    try std.testing.expectError(error.EmptyCommand, parse(" \t\n"));
+}
+
+test "capture runs the script with SIGCHLD unblocked" {
+    allocator = std.testing.allocator;
+    _ = c.sigemptyset(&empty_mask);
+    _ = c.sigemptyset(&child_mask);
+    _ = c.sigaddset(&child_mask, c.SIGCHLD);
+
+    var old_mask: c.sigset_t = undefined;
+    _ = c.sigprocmask(c.SIG_BLOCK, &child_mask, &old_mask);
+    defer _ = c.sigprocmask(c.SIG_SETMASK, &old_mask, null);
+
+    var output: [64]u8 = undefined;
+    const status = capture("grep '^SigBlk:' /proc/self/status", &output) orelse return error.TestCaptureFailed;
+    const blocked = try std.fmt.parseInt(u64, std.mem.trim(u8, status["SigBlk:".len..], " \t\n"), 16);
+    try std.testing.expectEqual(@as(u64, 0), blocked & (@as(u64, 1) << (c.SIGCHLD - 1)));
+
+    var short: [4]u8 = undefined;
+    try std.testing.expectEqualStrings("abcd", capture("printf abcdefgh", &short) orelse return error.TestCaptureFailed);
+}
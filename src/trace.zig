@@ -0,0 +1,237 @@
+const std = @import("std");
+const xlib = @import("x11/xlib.zig");
+const events = @import("x11/events.zig");
+const config_mod = @import("config/config.zig");
+
+const sub_bucket_bits = 2;
+const sub_buckets = 1 << sub_bucket_bits;
+const bucket_count = (64 - sub_bucket_bits + 1) * sub_buckets;
+const event_type_count = xlib.LASTEvent;
+const action_count = @typeInfo(config_mod.Action).@"enum".fields.len;
+const batch_capacity = 256;
+
+pub const Histogram = struct {
+    counts: [bucket_count]u32 = [_]u32{0} ** bucket_count,
+    total: u64 = 0,
+    sum_ns: u64 = 0,
+    max_ns: u64 = 0,
+
+    pub fn record(self: *Histogram, ns: u64) void {
+        self.counts[bucket_of(ns)] += 1;
+        self.total += 1;
+        self.sum_ns += ns;
+        self.max_ns = @max(self.max_ns, ns);
+    }
+
+    pub fn percentile(self: *const Histogram, fraction: f64) u64 {
+        if (self.total == 0) return 0;
+        const wanted: u64 = @max(1, @as(u64, @intFromFloat(@ceil(fraction * @as(f64, @floatFromInt(self.total))))));
+        var seen: u64 = 0;
+        for (self.counts, 0..) |count, bucket| {
+            seen += count;
+            if (seen >= wanted) return @min(bucket_ceiling(bucket), self.max_ns);
+        }
+        return self.max_ns;
+    }
+
+    fn bucket_of(ns: u64) usize {
+        if (ns < sub_buckets) return @intCast(ns);
+        const magnitude: u6 = @intCast(63 - @clz(ns));
+        const sub = (ns >> (magnitude - sub_bucket_bits)) & (sub_buckets - 1);
+        return (@as(usize, magnitude) - sub_bucket_bits + 1) * sub_buckets + @as(usize, @intCast(sub));
+    }
+
+    fn bucket_ceiling(bucket: usize) u64 {
+        if (bucket < sub_buckets) return bucket;
+        const magnitude: u6 = @intCast(bucket / sub_buckets + sub_bucket_bits - 1);
+        const sub: u64 = bucket % sub_buckets;
+        const width = @as(u64, 1) << (magnitude - sub_bucket_bits);
+        return (sub_buckets + sub) * width + (width - 1);
+    }
+};
+
+const Event_Stats = struct {
+    queue: Histogram = .{},
+    handle: Histogram = .{},
+    flush: Histogram = .{},
+    requests: u64 = 0,
+    round_trips: u64 = 0,
+};
+
+const Action_Stats = struct {
+    handle: Histogram = .{},
+    requests: u64 = 0,
+    round_trips: u64 = 0,
+};
+
+pub const Span = struct {
+    start_ns: u64,
+    request: c_ulong,
+    round_trips: u64,
+};
+
+const Batch_Entry = struct {
+    event_type: usize,
+    start_ns: u64,
+};
+
+var event_stats: [event_type_count]Event_Stats = [_]Event_Stats{.{}} ** event_type_count;
+var action_stats: [action_count]Action_Stats = [_]Action_Stats{.{}} ** action_count;
+var bar_stats: Action_Stats = .{};
+var batch: [batch_capacity]Batch_Entry = undefined;
+var batch_len: usize = 0;
+var wake_ns: u64 = 0;
+var display_handle: ?*xlib.Display = null;
+var dump_requested = std.atomic.Value(bool).init(false);
+
+pub fn init(display: *xlib.Display) void {
+    display_handle = display;
+    wake_ns = now();
+
+    const handler = std.posix.Sigaction{
+        .handler = .{ .handler = handle_sigusr1 },
+        .mask = std.mem.zeroes(std.posix.sigset_t),
+        .flags = std.posix.SA.RESTART,
+    };
+    std.posix.sigaction(std.posix.SIG.USR1, &handler, null);
+}
+
+fn handle_sigusr1(_: c_int) callconv(.c) void {
+    dump_requested.store(true, .release);
+}
+
+pub fn take_dump_request() bool {
+    return dump_requested.swap(false, .acq_rel);
+}
+
+pub fn now() u64 {
+    const ts = std.posix.clock_gettime(.MONOTONIC) catch return 0;
+    return @as(u64, @intCast(ts.sec)) * std.time.ns_per_s + @as(u64, @intCast(ts.nsec));
+}
+
+pub fn cpu_now() u64 {
+    const ts = std.posix.clock_gettime(.THREAD_CPUTIME_ID) catch return 0;
+    return @as(u64, @intCast(ts.sec)) * std.time.ns_per_s + @as(u64, @intCast(ts.nsec));
+}
+
+pub fn wake() void {
+    wake_ns = now();
+}
+
+pub fn begin() Span {
+    return .{
+        .start_ns = now(),
+        .request = if (display_handle) |display| xlib.XNextRequest(display) else 0,
+        .round_trips = xlib.round_trips,
+    };
+}
+
+pub fn end_event(event_type: events.EventType, span: Span) void {
+    const index: usize = @intCast(@intFromEnum(event_type));
+    if (index >= event_type_count) return;
+
+    const stats = &event_stats[index];
+    const end_ns = now();
+    stats.queue.record(span.start_ns -| wake_ns);
+    stats.handle.record(end_ns -| span.start_ns);
+    stats.requests += requests_since(span);
+    stats.round_trips += xlib.round_trips - span.round_trips;
+
+    if (batch_len < batch_capacity) {
+        batch[batch_len] = .{ .event_type = index, .start_ns = span.start_ns };
+        batch_len += 1;
+    }
+}
+
+pub fn end_action(action: config_mod.Action, span: Span) void {
+    const stats = &action_stats[@intFromEnum(action)];
+    stats.handle.record(now() -| span.start_ns);
+    stats.requests += requests_since(span);
+    stats.round_trips += xlib.round_trips - span.round_trips;
+}
+
+pub fn end_bar_draw(span: Span) void {
+    bar_stats.handle.record(now() -| span.start_ns);
+    bar_stats.requests += requests_since(span);
+    bar_stats.round_trips += xlib.round_trips - span.round_trips;
+}
+
+pub fn write_bar_json(writer: *std.Io.Writer) !void {
+    try writer.print("{{\"draws\":{d},\"p50_ns\":{d},\"p99_ns\":{d},\"max_ns\":{d},\"total_ns\":{d},\"requests\":{d},\"round_trips\":{d}}}", .{
+        bar_stats.handle.total,
+        bar_stats.handle.percentile(0.5),
+        bar_stats.handle.percentile(0.99),
+        bar_stats.handle.max_ns,
+        bar_stats.handle.sum_ns,
+        bar_stats.requests,
+        bar_stats.round_trips,
+    });
+}
+
+pub fn flushed() void {
+    const end_ns = now();
+    for (batch[0..batch_len]) |entry| {
+        event_stats[entry.event_type].flush.record(end_ns -| entry.start_ns);
+    }
+    batch_len = 0;
+}
+
+fn requests_since(span: Span) u64 {
+    const display = display_handle orelse return 0;
+    return xlib.XNextRequest(display) -% span.request;
+}
+
+pub fn dump(writer: *std.Io.Writer) !void {
+    try writer.print("{s:<20} {s:>8} {s:>10} {s:>10} {s:>10} {s:>10} {s:>10} {s:>8} {s:>8}\n", .{ "event", "count", "queue p50", "p50", "p99", "max", "flush p99", "reqs", "trips" });
+    for (event_stats, 0..) |*stats, index| {
+        if (stats.handle.total == 0) continue;
+        const event_type: events.EventType = @enumFromInt(@as(c_int, @intCast(index)));
+        try writer.print("{s:<20} {d:>8} {d:>10} {d:>10} {d:>10} {d:>10} {d:>10} {d:>8} {d:>8}\n", .{
+            events.event_name(event_type),
+            stats.handle.total,
+            stats.queue.percentile(0.5),
+            stats.handle.percentile(0.5),
+            stats.handle.percentile(0.99),
+            stats.handle.max_ns,
+            stats.flush.percentile(0.99),
+            stats.requests,
+            stats.round_trips,
+        });
+    }
+
+    try writer.print("\n{s:<20} {s:>8} {s:>10} {s:>10} {s:>10} {s:>8} {s:>8}\n", .{ "action", "count", "p50", "p99", "max", "reqs", "trips" });
+    for (action_stats, 0..) |*stats, index| {
+        if (stats.handle.total == 0) continue;
+        const action: config_mod.Action = @enumFromInt(index);
+        try writer.print("{s:<20} {d:>8} {d:>10} {d:>10} {d:>10} {d:>8} {d:>8}\n", .{
+            @tagName(action),
+            stats.handle.total,
+            stats.handle.percentile(0.5),
+            stats.handle.percentile(0.99),
+            stats.handle.max_ns,
+            stats.requests,
+            stats.round_trips,
+        });
+    }
+
+    if (bar_stats.handle.total > 0) {
+        try writer.print("{s:<20} {d:>8} {d:>10} {d:>10} {d:>10} {d:>8} {d:>8}\n", .{
+            "bar draw",
+            bar_stats.handle.total,
+            bar_stats.handle.percentile(0.5),
+            bar_stats.handle.percentile(0.99),
+            bar_stats.handle.max_ns,
+            bar_stats.requests,
+            bar_stats.round_trips,
+        });
+    }
+}
+
+pub fn dump_to_stderr() void {
+    var buffer: [4096]u8 = undefined;
+    var stderr_writer = std.fs.File.stderr().writer(&buffer);
+    const writer = &stderr_writer.interface;
+    writer.print("goonwm trace (ns)\n", .{}) catch return;
+    dump(writer) catch return;
+    writer.flush() catch return;
+}
@@ -1,5 +1,6 @@
 const std = @import("std");
 const xlib = @import("xlib.zig");
+const log = @import("../log.zig");
 
 pub const DisplayError = error{
     cannot_open_display,
@@ -35,7 +36,7 @@ pub const Display = struct {
         _ = xlib.XSelectInput(
             self.handle,
             self.root,
-            xlib.SubstructureRedirectMask | xlib.SubstructureNotifyMask | xlib.ButtonPressMask | xlib.PointerMotionMask | xlib.EnterWindowMask,
+            xlib.SubstructureRedirectMask | xlib.SubstructureNotifyMask | xlib.StructureNotifyMask | xlib.ButtonPressMask | xlib.PointerMotionMask | xlib.EnterWindowMask,
         );
         _ = xlib.XSync(self.handle, xlib.False);
 
@@ -95,6 +96,6 @@ fn on_wm_detected(_: ?*xlib.Display, _: [*c]xlib.XErrorEvent) callconv(.c) c_int
 }
 
 fn on_x_error(_: ?*xlib.Display, event: [*c]xlib.XErrorEvent) callconv(.c) c_int {
-    std.debug.print("x11 error: request={d} error={d}\n", .{ event.*.request_code, event.*.error_code });
+    log.warn(.x11, "error: request={d} error={d} resource=0x{x}", .{ event.*.request_code, event.*.error_code, event.*.resourceid });
     return 0;
 }
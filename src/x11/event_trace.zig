@@ -0,0 +1,116 @@
+const std = @import("std");
+pub const xlib = @import("xlib.zig");
+
+pub const magic = "GOONTRC1";
+
+const kind_batch_end: u8 = 0;
+const kind_event: u8 = 1;
+const header_len = 5;
+
+pub const Entry = union(enum) {
+    event: xlib.XEvent,
+    batch_end,
+};
+
+var file: ?std.fs.File = null;
+var file_buffer: [64 * 1024]u8 = undefined;
+var file_writer: std.fs.File.Writer = undefined;
+var last_ns: ?u64 = null;
+
+pub fn start(path: []const u8) !void {
+    finish();
+    const created = try std.fs.cwd().createFile(path, .{});
+    file = created;
+    file_writer = created.writer(&file_buffer);
+    last_ns = null;
+    try file_writer.interface.writeAll(magic);
+}
+
+pub fn recording() bool {
+    return file != null;
+}
+
+pub fn record(event: *const xlib.XEvent, time_ns: u64) !void {
+    const size = event_size(event.type);
+    const bytes: [*]const u8 = @ptrCast(event);
+    try write_header(kind_event, time_ns);
+    try file_writer.interface.writeInt(u16, @intCast(size), .little);
+    try file_writer.interface.writeAll(bytes[0..size]);
+}
+
+pub fn end_batch(time_ns: u64) !void {
+    try write_header(kind_batch_end, time_ns);
+}
+
+pub fn finish() void {
+    const current = file orelse return;
+    file_writer.interface.flush() catch {};
+    current.close();
+    file = null;
+}
+
+fn write_header(kind: u8, time_ns: u64) !void {
+    if (file == null) return error.NotRecording;
+    var delta_us: u64 = 0;
+    if (last_ns) |last| {
+        delta_us = @min((time_ns -| last) / std.time.ns_per_us, std.math.maxInt(u32));
+        last_ns = last + delta_us * std.time.ns_per_us;
+    } else {
+        last_ns = time_ns;
+    }
+    try file_writer.interface.writeByte(kind);
+    try file_writer.interface.writeInt(u32, @intCast(delta_us), .little);
+}
+
+fn event_size(event_type: c_int) usize {
+    return switch (event_type) {
+        xlib.KeyPress, xlib.KeyRelease => @sizeOf(xlib.XKeyEvent),
+        xlib.ButtonPress, xlib.ButtonRelease => @sizeOf(xlib.XButtonEvent),
+        xlib.MotionNotify => @sizeOf(xlib.XMotionEvent),
+        xlib.EnterNotify, xlib.LeaveNotify => @sizeOf(xlib.XCrossingEvent),
+        xlib.FocusIn, xlib.FocusOut => @sizeOf(xlib.XFocusChangeEvent),
+        xlib.Expose => @sizeOf(xlib.XExposeEvent),
+        xlib.DestroyNotify => @sizeOf(xlib.XDestroyWindowEvent),
+        xlib.UnmapNotify => @sizeOf(xlib.XUnmapEvent),
+        xlib.MapNotify => @sizeOf(xlib.c.XMapEvent),
+        xlib.MapRequest => @sizeOf(xlib.XMapRequestEvent),
+        xlib.ConfigureNotify => @sizeOf(xlib.c.XConfigureEvent),
+        xlib.ConfigureRequest => @sizeOf(xlib.XConfigureRequestEvent),
+        xlib.PropertyNotify => @sizeOf(xlib.XPropertyEvent),
+        xlib.ClientMessage => @sizeOf(xlib.XClientMessageEvent),
+        xlib.MappingNotify => @sizeOf(xlib.XMappingEvent),
+        else => @sizeOf(xlib.XEvent),
+    };
+}
+
+pub const Reader = struct {
+    data: []const u8,
+    offset: usize = magic.len,
+    time_us: u64 = 0,
+
+    pub fn init(data: []const u8) error{InvalidTrace}!Reader {
+        if (!std.mem.startsWith(u8, data, magic)) return error.InvalidTrace;
+        return .{ .data = data };
+    }
+
+    pub fn next(self: *Reader) error{InvalidTrace}!?Entry {
+        if (self.offset == self.data.len) return null;
+        if (self.data.len - self.offset < header_len) return error.InvalidTrace;
+
+        const kind = self.data[self.offset];
+        self.time_us += std.mem.readInt(u32, self.data[self.offset + 1 ..][0..4], .little);
+        self.offset += header_len;
+        if (kind == kind_batch_end) return .batch_end;
+        if (kind != kind_event or self.data.len - self.offset < 2) return error.InvalidTrace;
+
+        const size = std.mem.readInt(u16, self.data[self.offset..][0..2], .little);
+        self.offset += 2;
+        if (size > @sizeOf(xlib.XEvent) or self.data.len - self.offset < size) return error.InvalidTrace;
+
+        var event = std.mem.zeroes(xlib.XEvent);
+        const bytes: [*]u8 = @ptrCast(&event);
+        @memcpy(bytes[0..size], self.data[self.offset..][0..size]);
+        self.offset += size;
+        return .{ .event = event };
+    }
+};
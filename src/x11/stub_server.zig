@@ -0,0 +1,373 @@
+const std = @import("std");
+const posix = std.posix;
+
+const root_window: u32 = 0x100;
+const default_colormap: u32 = 0x20;
+const root_visual: u32 = 0x21;
+const screen_width: u16 = 1920;
+const screen_height: u16 = 1080;
+const min_keycode: u8 = 8;
+const max_keycode: u8 = 255;
+const first_free_atom: u32 = 69;
+const xa_string: u32 = 31;
+const xa_wm_name: u32 = 39;
+const xa_wm_class: u32 = 67;
+const max_request_bytes = 65535 * 4;
+
+const op_get_window_attributes = 3;
+const op_get_geometry = 14;
+const op_query_tree = 15;
+const op_intern_atom = 16;
+const op_get_property = 20;
+const op_grab_pointer = 26;
+const op_query_pointer = 38;
+const op_get_input_focus = 43;
+const op_query_extension = 98;
+const op_get_keyboard_mapping = 101;
+const op_get_modifier_mapping = 119;
+
+const reply_opcodes = [_]u8{ 3, 14, 15, 16, 17, 20, 21, 23, 26, 31, 38, 39, 40, 43, 44, 47, 48, 49, 50, 52, 73, 83, 84, 85, 86, 87, 91, 92, 97, 98, 99, 101, 103, 106, 108, 110, 116, 117, 118, 119 };
+
+const us_keymap = [_]struct { keycode: u8, keysym: u32 }{
+    .{ .keycode = 9, .keysym = 0xff1b },
+    .{ .keycode = 10, .keysym = '1' },
+    .{ .keycode = 11, .keysym = '2' },
+    .{ .keycode = 12, .keysym = '3' },
+    .{ .keycode = 13, .keysym = '4' },
+    .{ .keycode = 14, .keysym = '5' },
+    .{ .keycode = 15, .keysym = '6' },
+    .{ .keycode = 16, .keysym = '7' },
+    .{ .keycode = 17, .keysym = '8' },
+    .{ .keycode = 18, .keysym = '9' },
+    .{ .keycode = 19, .keysym = '0' },
+    .{ .keycode = 23, .keysym = 0xff09 },
+    .{ .keycode = 24, .keysym = 'q' },
+    .{ .keycode = 25, .keysym = 'w' },
+    .{ .keycode = 26, .keysym = 'e' },
+    .{ .keycode = 27, .keysym = 'r' },
+    .{ .keycode = 28, .keysym = 't' },
+    .{ .keycode = 29, .keysym = 'y' },
+    .{ .keycode = 30, .keysym = 'u' },
+    .{ .keycode = 31, .keysym = 'i' },
+    .{ .keycode = 32, .keysym = 'o' },
+    .{ .keycode = 33, .keysym = 'p' },
+    .{ .keycode = 36, .keysym = 0xff0d },
+    .{ .keycode = 38, .keysym = 'a' },
+    .{ .keycode = 39, .keysym = 's' },
+    .{ .keycode = 40, .keysym = 'd' },
+    .{ .keycode = 41, .keysym = 'f' },
+    .{ .keycode = 42, .keysym = 'g' },
+    .{ .keycode = 43, .keysym = 'h' },
+    .{ .keycode = 44, .keysym = 'j' },
+    .{ .keycode = 45, .keysym = 'k' },
+    .{ .keycode = 46, .keysym = 'l' },
+    .{ .keycode = 52, .keysym = 'z' },
+    .{ .keycode = 53, .keysym = 'x' },
+    .{ .keycode = 54, .keysym = 'c' },
+    .{ .keycode = 55, .keysym = 'v' },
+    .{ .keycode = 56, .keysym = 'b' },
+    .{ .keycode = 57, .keysym = 'n' },
+    .{ .keycode = 58, .keysym = 'm' },
+    .{ .keycode = 59, .keysym = ',' },
+    .{ .keycode = 60, .keysym = '.' },
+    .{ .keycode = 65, .keysym = ' ' },
+    .{ .keycode = 77, .keysym = 0xff7f },
+    .{ .keycode = 133, .keysym = 0xffeb },
+};
+
+var listen_fd: posix.socket_t = -1;
+var server_thread: ?std.Thread = null;
+var name_buffer: [32]u8 = undefined;
+var request_buffer: [max_request_bytes + 4096]u8 = undefined;
+var reply_buffer: [4096]u8 = undefined;
+var keysyms: [256]u32 = [_]u32{0} ** 256;
+var opcode_counts: [256]u64 = [_]u64{0} ** 256;
+var sequence: u16 = 0;
+var next_atom: u32 = first_free_atom;
+var title_serial: u32 = 0;
+
+pub fn start() ![]const u8 {
+    for (us_keymap) |entry| keysyms[entry.keycode] = entry.keysym;
+
+    const base: u32 = 4000 + @as(u32, @intCast(std.os.linux.getpid())) % 1000;
+    var attempt: u32 = 0;
+    while (attempt < 64) : (attempt += 1) {
+        const number = base + attempt;
+        const fd = try posix.socket(posix.AF.UNIX, posix.SOCK.STREAM | posix.SOCK.CLOEXEC, 0);
+
+        var address = posix.sockaddr.un{ .family = posix.AF.UNIX, .path = undefined };
+        @memset(&address.path, 0);
+        const path = try std.fmt.bufPrint(address.path[1..], "/tmp/.X11-unix/X{d}", .{number});
+        const len: posix.socklen_t = @intCast(@offsetOf(posix.sockaddr.un, "path") + 1 + path.len);
+
+        posix.bind(fd, @ptrCast(&address), len) catch {
+            posix.close(fd);
+            continue;
+        };
+        try posix.listen(fd, 1);
+        listen_fd = fd;
+        server_thread = try std.Thread.spawn(.{}, serve, .{});
+        return std.fmt.bufPrint(&name_buffer, ":{d}", .{number});
+    }
+    return error.AddressInUse;
+}
+
+pub fn stop() void {
+    if (listen_fd >= 0) posix.shutdown(listen_fd, .both) catch {};
+    if (server_thread) |thread| thread.join();
+    server_thread = null;
+    if (listen_fd >= 0) posix.close(listen_fd);
+    listen_fd = -1;
+}
+
+pub fn reset_counts() void {
+    for (&opcode_counts) |*counter| @atomicStore(u64, counter, 0, .monotonic);
+}
+
+pub fn count(opcode: u8) u64 {
+    return @atomicLoad(u64, &opcode_counts[opcode], .monotonic);
+}
+
+pub fn total_requests() u64 {
+    var total: u64 = 0;
+    for (0..opcode_counts.len) |opcode| total += count(@intCast(opcode));
+    return total;
+}
+
+pub fn opcode_name(opcode: u8) []const u8 {
+    return switch (opcode) {
+        1 => "CreateWindow",
+        2 => "ChangeWindowAttributes",
+        3 => "GetWindowAttributes",
+        4 => "DestroyWindow",
+        8 => "MapWindow",
+        10 => "UnmapWindow",
+        12 => "ConfigureWindow",
+        14 => "GetGeometry",
+        15 => "QueryTree",
+        16 => "InternAtom",
+        18 => "ChangeProperty",
+        19 => "DeleteProperty",
+        20 => "GetProperty",
+        25 => "SendEvent",
+        26 => "GrabPointer",
+        27 => "UngrabPointer",
+        28 => "GrabButton",
+        29 => "UngrabButton",
+        33 => "GrabKey",
+        34 => "UngrabKey",
+        35 => "AllowEvents",
+        36 => "GrabServer",
+        37 => "UngrabServer",
+        38 => "QueryPointer",
+        41 => "WarpPointer",
+        42 => "SetInputFocus",
+        43 => "GetInputFocus",
+        53 => "CreatePixmap",
+        54 => "FreePixmap",
+        55 => "CreateGC",
+        56 => "ChangeGC",
+        60 => "FreeGC",
+        62 => "CopyArea",
+        70 => "PolyFillRectangle",
+        98 => "QueryExtension",
+        101 => "GetKeyboardMapping",
+        113 => "KillClient",
+        119 => "GetModifierMapping",
+        else => "other",
+    };
+}
+
+fn serve() void {
+    const fd = posix.accept(listen_fd, null, null, posix.SOCK.CLOEXEC) catch return;
+    defer posix.close(fd);
+    handshake(fd) catch return;
+
+    var len: usize = 0;
+    while (true) {
+        const received = posix.read(fd, request_buffer[len..]) catch return;
+        if (received == 0) return;
+        len += received;
+
+        var offset: usize = 0;
+        while (len - offset >= 4) {
+            const words = std.mem.readInt(u16, request_buffer[offset + 2 ..][0..2], .little);
+            const size = @as(usize, words) * 4;
+            if (size == 0) return;
+            if (len - offset < size) break;
+            handle_request(fd, request_buffer[offset..][0..size]) catch return;
+            offset += size;
+        }
+        std.mem.copyForwards(u8, request_buffer[0 .. len - offset], request_buffer[offset..len]);
+        len -= offset;
+    }
+}
+
+fn read_exact(fd: posix.socket_t, buffer: []u8) !void {
+    var filled: usize = 0;
+    while (filled < buffer.len) {
+        const received = try posix.read(fd, buffer[filled..]);
+        if (received == 0) return error.EndOfStream;
+        filled += received;
+    }
+}
+
+fn write_all(fd: posix.socket_t, bytes: []const u8) !void {
+    var sent: usize = 0;
+    while (sent < bytes.len) {
+        sent += try posix.send(fd, bytes[sent..], posix.MSG.NOSIGNAL);
+    }
+}
+
+fn pad(len: usize) usize {
+    return (len + 3) & ~@as(usize, 3);
+}
+
+fn handshake(fd: posix.socket_t) !void {
+    var header: [12]u8 = undefined;
+    try read_exact(fd, &header);
+    if (header[0] != 'l') return error.UnsupportedByteOrder;
+    const auth_len = pad(std.mem.readInt(u16, header[6..8], .little)) + pad(std.mem.readInt(u16, header[8..10], .little));
+    if (auth_len > reply_buffer.len) return error.AuthTooLong;
+    try read_exact(fd, reply_buffer[0..auth_len]);
+
+    const vendor = "goonwm-stub";
+    var setup: [8 + 124]u8 = std.mem.zeroes([8 + 124]u8);
+    var writer = std.Io.Writer.fixed(&setup);
+    try writer.writeAll(&.{ 1, 0 });
+    try writer.writeInt(u16, 11, .little);
+    try writer.writeInt(u16, 0, .little);
+    try writer.writeInt(u16, 124 / 4, .little);
+
+    try writer.writeInt(u32, 1, .little);
+    try writer.writeInt(u32, 0x00200000, .little);
+    try writer.writeInt(u32, 0x001fffff, .little);
+    try writer.writeInt(u32, 0, .little);
+    try writer.writeInt(u16, vendor.len, .little);
+    try writer.writeInt(u16, 65535, .little);
+    try writer.writeAll(&.{ 1, 1, 0, 0, 32, 32, min_keycode, max_keycode, 0, 0, 0, 0 });
+    try writer.writeAll(vendor ++ "\x00");
+
+    try writer.writeAll(&.{ 24, 32, 32, 0, 0, 0, 0, 0 });
+
+    try writer.writeInt(u32, root_window, .little);
+    try writer.writeInt(u32, default_colormap, .little);
+    try writer.writeInt(u32, 0xffffff, .little);
+    try writer.writeInt(u32, 0, .little);
+    try writer.writeInt(u32, 0, .little);
+    try writer.writeInt(u16, screen_width, .little);
+    try writer.writeInt(u16, screen_height, .little);
+    try writer.writeInt(u16, 508, .little);
+    try writer.writeInt(u16, 286, .little);
+    try writer.writeInt(u16, 1, .little);
+    try writer.writeInt(u16, 1, .little);
+    try writer.writeInt(u32, root_visual, .little);
+    try writer.writeAll(&.{ 0, 0, 24, 1 });
+
+    try writer.writeAll(&.{ 24, 0 });
+    try writer.writeInt(u16, 1, .little);
+    try writer.writeInt(u32, 0, .little);
+
+    try writer.writeInt(u32, root_visual, .little);
+    try writer.writeAll(&.{ 4, 8 });
+    try writer.writeInt(u16, 256, .little);
+    try writer.writeInt(u32, 0xff0000, .little);
+    try writer.writeInt(u32, 0x00ff00, .little);
+    try writer.writeInt(u32, 0x0000ff, .little);
+    try writer.writeInt(u32, 0, .little);
+
+    try write_all(fd, writer.buffered());
+}
+
+fn handle_request(fd: posix.socket_t, request: []const u8) !void {
+    sequence +%= 1;
+    const opcode = request[0];
+    _ = @atomicRmw(u64, &opcode_counts[opcode], .Add, 1, .monotonic);
+    if (std.mem.indexOfScalar(u8, &reply_opcodes, opcode) == null) return;
+
+    @memset(&reply_buffer, 0);
+    reply_buffer[0] = 1;
+    std.mem.writeInt(u16, reply_buffer[2..4], sequence, .little);
+    var extra: usize = 0;
+
+    switch (opcode) {
+        op_get_window_attributes => {
+            extra = 12;
+            reply_buffer[1] = 0;
+            std.mem.writeInt(u32, reply_buffer[8..12], root_visual, .little);
+            std.mem.writeInt(u16, reply_buffer[12..14], 1, .little);
+            reply_buffer[26] = 2;
+            std.mem.writeInt(u32, reply_buffer[28..32], default_colormap, .little);
+        },
+        op_get_geometry => {
+            reply_buffer[1] = 24;
+            std.mem.writeInt(u32, reply_buffer[8..12], root_window, .little);
+            std.mem.writeInt(u16, reply_buffer[16..18], 640, .little);
+            std.mem.writeInt(u16, reply_buffer[18..20], 480, .little);
+        },
+        op_query_tree => {
+            std.mem.writeInt(u32, reply_buffer[8..12], root_window, .little);
+        },
+        op_intern_atom => {
+            std.mem.writeInt(u32, reply_buffer[8..12], next_atom, .little);
+            next_atom += 1;
+        },
+        op_get_property => extra = write_property(request),
+        op_grab_pointer => reply_buffer[1] = 0,
+        op_query_pointer => {
+            reply_buffer[1] = 1;
+            std.mem.writeInt(u32, reply_buffer[8..12], root_window, .little);
+        },
+        op_get_input_focus => {
+            reply_buffer[1] = 1;
+            std.mem.writeInt(u32, reply_buffer[8..12], root_window, .little);
+        },
+        op_query_extension => reply_buffer[8] = 0,
+        op_get_keyboard_mapping => extra = write_keyboard_mapping(request),
+        op_get_modifier_mapping => reply_buffer[1] = 0,
+        else => {},
+    }
+
+    std.mem.writeInt(u32, reply_buffer[4..8], @intCast(extra / 4), .little);
+    try write_all(fd, reply_buffer[0 .. 32 + extra]);
+}
+
+fn write_property(request: []const u8) usize {
+    if (request.len < 24) return 0;
+    const window = std.mem.readInt(u32, request[4..8], .little);
+    const property = std.mem.readInt(u32, request[8..12], .little);
+
+    var value_buffer: [64]u8 = undefined;
+    const value: []const u8 = switch (property) {
+        xa_wm_name => blk: {
+            title_serial +%= 1;
+            break :blk std.fmt.bufPrint(&value_buffer, "window 0x{x} #{d}", .{ window, title_serial }) catch return 0;
+        },
+        xa_wm_class => blk: {
+            const app = window % 7;
+            break :blk std.fmt.bufPrint(&value_buffer, "app{d}\x00App{d}\x00", .{ app, app }) catch return 0;
+        },
+        else => return 0,
+    };
+
+    reply_buffer[1] = 8;
+    std.mem.writeInt(u32, reply_buffer[8..12], xa_string, .little);
+    std.mem.writeInt(u32, reply_buffer[16..20], @intCast(value.len), .little);
+    @memcpy(reply_buffer[32..][0..value.len], value);
+    return pad(value.len);
+}
+
+fn write_keyboard_mapping(request: []const u8) usize {
+    if (request.len < 8) return 0;
+    const first = request[4];
+    const requested: usize = request[5];
+    const mapped = @min(requested, (reply_buffer.len - 32) / 4);
+
+    reply_buffer[1] = 1;
+    for (0..mapped) |index| {
+        const keycode = @as(usize, first) + index;
+        const keysym = if (keycode < keysyms.len) keysyms[keycode] else 0;
+        std.mem.writeInt(u32, reply_buffer[32 + index * 4 ..][0..4], keysym, .little);
+    }
+    return mapped * 4;
+}
@@ -1,3 +1,5 @@
+const std = @import("std");
+
 pub const c = @cImport({
     @cInclude("X11/Xlib.h");
     @cInclude("X11/Xutil.h");
@@ -5,7 +7,13 @@ pub const c = @cImport({
     @cInclude("X11/cursorfont.h");
     @cInclude("X11/keysym.h");
     @cInclude("X11/extensions/Xinerama.h");
+    @cInclude("X11/extensions/Xrandr.h");
     @cInclude("X11/Xft/Xft.h");
+    @cInclude("sys/ipc.h");
+    @cInclude("sys/shm.h");
+    @cInclude("X11/extensions/XShm.h");
+    @cInclude("X11/Xlib-xcb.h");
+    @cInclude("xcb/xcb.h");
 });
 
 pub const Display = c.Display;
@@ -32,21 +40,32 @@ pub const XDisplayWidth = c.XDisplayWidth;
 pub const XDisplayHeight = c.XDisplayHeight;
 pub const XNextEvent = c.XNextEvent;
 pub const XPending = c.XPending;
-pub const XSync = c.XSync;
+pub const XSync = round_trip(c.XSync);
+pub const XFlush = c.XFlush;
+pub const XNextRequest = c.XNextRequest;
 pub const XSelectInput = c.XSelectInput;
 pub const XSetErrorHandler = c.XSetErrorHandler;
 pub const XGrabKey = c.XGrabKey;
 pub const XKeysymToKeycode = c.XKeysymToKeycode;
 pub const XKeycodeToKeysym = c.XKeycodeToKeysym;
-pub const XQueryTree = c.XQueryTree;
+pub const XGetKeyboardMapping = round_trip(c.XGetKeyboardMapping);
+pub const XDisplayKeycodes = c.XDisplayKeycodes;
+pub const XRefreshKeyboardMapping = c.XRefreshKeyboardMapping;
+pub const XMappingEvent = c.XMappingEvent;
+pub const MappingKeyboard = c.MappingKeyboard;
+pub const MappingModifier = c.MappingModifier;
+pub const XQueryTree = round_trip(c.XQueryTree);
 pub const XFree = c.XFree;
-pub const XGetWindowAttributes = c.XGetWindowAttributes;
+pub const XGetWindowAttributes = round_trip(c.XGetWindowAttributes);
 pub const XMapWindow = c.XMapWindow;
 pub const XConfigureWindow = c.XConfigureWindow;
 pub const XSetInputFocus = c.XSetInputFocus;
 pub const XRaiseWindow = c.XRaiseWindow;
 pub const XMoveResizeWindow = c.XMoveResizeWindow;
+pub const XResizeWindow = c.XResizeWindow;
 pub const XMoveWindow = c.XMoveWindow;
+pub const XUnmapWindow = c.XUnmapWindow;
+pub const XCheckTypedWindowEvent = c.XCheckTypedWindowEvent;
 pub const XSetWindowBorder = c.XSetWindowBorder;
 pub const XSetWindowBorderWidth = c.XSetWindowBorderWidth;
 
@@ -103,9 +122,10 @@ pub const Mod3Mask = c.Mod3Mask;
 pub const Mod5Mask = c.Mod5Mask;
 
 pub const XKillClient = c.XKillClient;
-pub const XInternAtom = c.XInternAtom;
+pub const XInternAtom = round_trip(c.XInternAtom);
+pub const XInternAtoms = round_trip(c.XInternAtoms);
 pub const XChangeProperty = c.XChangeProperty;
-pub const XGetWindowProperty = c.XGetWindowProperty;
+pub const XGetWindowProperty = round_trip(c.XGetWindowProperty);
 pub const XSendEvent = c.XSendEvent;
 
 pub const Atom = c.Atom;
@@ -114,12 +134,12 @@ pub const XClientMessageEvent = c.XClientMessageEvent;
 
 pub const PropModeReplace = c.PropModeReplace;
 
-pub const XGrabPointer = c.XGrabPointer;
+pub const XGrabPointer = round_trip(c.XGrabPointer);
 pub const XUngrabPointer = c.XUngrabPointer;
 pub const XGrabButton = c.XGrabButton;
-pub const XQueryPointer = c.XQueryPointer;
+pub const XQueryPointer = round_trip(c.XQueryPointer);
 pub const XWarpPointer = c.XWarpPointer;
-pub const XGetModifierMapping = c.XGetModifierMapping;
+pub const XGetModifierMapping = round_trip(c.XGetModifierMapping);
 pub const XFreeModifiermap = c.XFreeModifiermap;
 pub const XModifierKeymap = c.XModifierKeymap;
 pub const XK_Num_Lock = c.XK_Num_Lock;
@@ -139,14 +159,22 @@ pub const XButtonEvent = c.XButtonEvent;
 pub const XMotionEvent = c.XMotionEvent;
 pub const XExposeEvent = c.XExposeEvent;
 
-pub const XineramaIsActive = c.XineramaIsActive;
-pub const XineramaQueryScreens = c.XineramaQueryScreens;
+pub const XineramaIsActive = round_trip(c.XineramaIsActive);
+pub const XineramaQueryScreens = round_trip(c.XineramaQueryScreens);
 pub const XineramaScreenInfo = c.XineramaScreenInfo;
+pub const XRRQueryExtension = round_trip(c.XRRQueryExtension);
+pub const XRRSelectInput = c.XRRSelectInput;
+pub const XRRUpdateConfiguration = c.XRRUpdateConfiguration;
+pub const RRScreenChangeNotify = c.RRScreenChangeNotify;
+pub const RRNotify = c.RRNotify;
+pub const RRScreenChangeNotifyMask = c.RRScreenChangeNotifyMask;
+pub const RRCrtcChangeNotifyMask = c.RRCrtcChangeNotifyMask;
+pub const RROutputChangeNotifyMask = c.RROutputChangeNotifyMask;
 
 pub const XftFont = c.XftFont;
 pub const XftColor = c.XftColor;
 pub const XftDraw = c.XftDraw;
-pub const XftFontOpenName = c.XftFontOpenName;
+pub const XftFontOpenName = round_trip(c.XftFontOpenName);
 pub const XftFontClose = c.XftFontClose;
 pub const XftDrawCreate = c.XftDrawCreate;
 pub const XftDrawDestroy = c.XftDrawDestroy;
@@ -178,6 +206,7 @@ pub const KeyRelease = c.KeyRelease;
 pub const ButtonPress = c.ButtonPress;
 pub const ButtonRelease = c.ButtonRelease;
 pub const MotionNotify = c.MotionNotify;
+pub const LASTEvent = c.LASTEvent;
 pub const EnterNotify = c.EnterNotify;
 pub const LeaveNotify = c.LeaveNotify;
 pub const FocusIn = c.FocusIn;
@@ -209,19 +238,19 @@ pub const MappingNotify = c.MappingNotify;
 pub const GenericEvent = c.GenericEvent;
 
 pub const XClassHint = c.XClassHint;
-pub const XGetClassHint = c.XGetClassHint;
+pub const XGetClassHint = round_trip(c.XGetClassHint);
 pub const XWMHints = c.XWMHints;
-pub const XGetWMHints = c.XGetWMHints;
+pub const XGetWMHints = round_trip(c.XGetWMHints);
 pub const XSetWMHints = c.XSetWMHints;
 pub const XSizeHints = c.XSizeHints;
-pub const XGetWMNormalHints = c.XGetWMNormalHints;
-pub const XGetTransientForHint = c.XGetTransientForHint;
+pub const XGetWMNormalHints = round_trip(c.XGetWMNormalHints);
+pub const XGetTransientForHint = round_trip(c.XGetTransientForHint);
 pub const XTextProperty = c.XTextProperty;
-pub const XGetTextProperty = c.XGetTextProperty;
+pub const XGetTextProperty = round_trip(c.XGetTextProperty);
 pub const XmbTextPropertyToTextList = c.XmbTextPropertyToTextList;
 pub const XFreeStringList = c.XFreeStringList;
 pub const Success = c.Success;
-pub const XGetWMProtocols = c.XGetWMProtocols;
+pub const XGetWMProtocols = round_trip(c.XGetWMProtocols);
 pub const XAllocSizeHints = c.XAllocSizeHints;
 
 pub const XUrgencyHint = c.XUrgencyHint;
@@ -244,6 +273,9 @@ pub const PropertyDelete = c.PropertyDelete;
 pub const XA_WM_TRANSIENT_FOR = c.XA_WM_TRANSIENT_FOR;
 pub const XA_WM_NORMAL_HINTS = c.XA_WM_NORMAL_HINTS;
 pub const XA_WM_HINTS = c.XA_WM_HINTS;
+pub const XA_WM_CLASS = c.XA_WM_CLASS;
+pub const XA_WM_SIZE_HINTS = c.XA_WM_SIZE_HINTS;
+pub const AnyPropertyType = c.AnyPropertyType;
 
 pub const XDeleteProperty = c.XDeleteProperty;
 pub const XCreateSimpleWindow = c.XCreateSimpleWindow;
@@ -266,3 +298,80 @@ pub const XC_fleur = c.XC_fleur;
 pub const XAllowEvents = c.XAllowEvents;
 pub const ReplayPointer = c.ReplayPointer;
 pub const AnyButton = c.AnyButton;
+
+pub var round_trips: u64 = 0;
+
+pub const XShmQueryExtension = round_trip(c.XShmQueryExtension);
+
+pub fn xcb_reply(comptime Reply: type, connection: ?*c.xcb_connection_t, sequence: c_uint) [*c]Reply {
+    var reply: ?*anyopaque = null;
+    var reply_error: [*c]c.xcb_generic_error_t = null;
+    if (c.xcb_poll_for_reply(connection, sequence, &reply, &reply_error) == 0) {
+        round_trips += 1;
+        reply = c.xcb_wait_for_reply(connection, sequence, &reply_error);
+    }
+    std.c.free(reply_error);
+    return @ptrCast(@alignCast(reply));
+}
+
+fn round_trip(comptime function: anytype) @TypeOf(function) {
+    const info = @typeInfo(@TypeOf(function)).@"fn";
+    const P = struct {
+        fn at(comptime index: usize) type {
+            return info.params[index].type.?;
+        }
+    };
+    const R = info.return_type.?;
+
+    return switch (info.params.len) {
+        1 => struct {
+            fn call(a: P.at(0)) callconv(.c) R {
+                round_trips += 1;
+                return function(a);
+            }
+        }.call,
+        2 => struct {
+            fn call(a: P.at(0), b: P.at(1)) callconv(.c) R {
+                round_trips += 1;
+                return function(a, b);
+            }
+        }.call,
+        3 => struct {
+            fn call(a: P.at(0), b: P.at(1), d: P.at(2)) callconv(.c) R {
+                round_trips += 1;
+                return function(a, b, d);
+            }
+        }.call,
+        4 => struct {
+            fn call(a: P.at(0), b: P.at(1), d: P.at(2), e: P.at(3)) callconv(.c) R {
+                round_trips += 1;
+                return function(a, b, d, e);
+            }
+        }.call,
+        5 => struct {
+            fn call(a: P.at(0), b: P.at(1), d: P.at(2), e: P.at(3), f: P.at(4)) callconv(.c) R {
+                round_trips += 1;
+                return function(a, b, d, e, f);
+            }
+        }.call,
+        6 => struct {
+            fn call(a: P.at(0), b: P.at(1), d: P.at(2), e: P.at(3), f: P.at(4), g: P.at(5)) callconv(.c) R {
+                round_trips += 1;
+                return function(a, b, d, e, f, g);
+            }
+        }.call,
+        9 => struct {
+            fn call(a: P.at(0), b: P.at(1), d: P.at(2), e: P.at(3), f: P.at(4), g: P.at(5), h: P.at(6), i: P.at(7), j: P.at(8)) callconv(.c) R {
+                round_trips += 1;
+                return function(a, b, d, e, f, g, h, i, j);
+            }
+        }.call,
+        12 => struct {
+            fn call(a: P.at(0), b: P.at(1), d: P.at(2), e: P.at(3), f: P.at(4), g: P.at(5), h: P.at(6), i: P.at(7), j: P.at(8), k: P.at(9), l: P.at(10), m: P.at(11)) callconv(.c) R {
+                round_trips += 1;
+                return function(a, b, d, e, f, g, h, i, j, k, l, m);
+            }
+        }.call,
+        else => @compileError("round_trip: unsupported arity"),
+    };
+}